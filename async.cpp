@@ -0,0 +1,169 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic_async.h"
+
+#include <algorithm>
+
+namespace flic {
+
+AsyncDecoder::AsyncDecoder(FileInterface* file, int nbuffers)
+  : m_decoder(file)
+  , m_slots(std::max(2, nbuffers))
+  , m_lastSlot(-1)
+  , m_head(0)
+  , m_ready(0)
+  , m_held(false)
+  , m_nextFrame(0)
+  , m_seekFrame(-1)
+  , m_generation(0)
+  , m_finished(false)
+  , m_exit(false)
+  , m_frameIndex(-1)
+{
+}
+
+AsyncDecoder::~AsyncDecoder()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exit = true;
+  }
+  m_workerCv.notify_one();
+
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+bool AsyncDecoder::readHeader(Header& header)
+{
+  if (m_thread.joinable() ||
+      !m_decoder.readHeader(header))
+    return false;
+
+  m_header = header;
+
+  const size_t size = size_t(header.width)*header.height;
+  for (Slot& slot : m_slots) {
+    slot.pixels.resize(size);
+    slot.frame.pixels = slot.pixels.data();
+    slot.frame.rowstride = header.width;
+    slot.index = -1;
+  }
+
+  m_thread = std::thread([this]{ workerLoop(); });
+  return true;
+}
+
+const Frame* AsyncDecoder::nextFrame(bool wait)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // Release the previous frame, so the worker can re-use its slot
+  if (m_held) {
+    m_held = false;
+    m_workerCv.notify_one();
+  }
+
+  if (wait) {
+    m_readyCv.wait(lock, [this]{
+      return m_ready > 0 || (m_finished && m_seekFrame < 0);
+    });
+  }
+  if (m_ready == 0)
+    return nullptr;
+
+  Slot& slot = m_slots[m_head];
+  m_head = (m_head+1) % int(m_slots.size());
+  --m_ready;
+  m_held = true;
+  m_frameIndex = slot.index;
+  return &slot.frame;
+}
+
+bool AsyncDecoder::end()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return (m_ready == 0 && m_finished && m_seekFrame < 0);
+}
+
+void AsyncDecoder::seekFrame(int frameIndex)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready = 0;
+    m_held = false;
+    m_seekFrame = frameIndex;
+    ++m_generation;
+  }
+  m_workerCv.notify_one();
+}
+
+void AsyncDecoder::workerLoop()
+{
+  const int nslots = int(m_slots.size());
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    // Wait a free slot (back-pressure) or a seek request
+    m_workerCv.wait(lock, [this, nslots]{
+      return m_exit || m_seekFrame >= 0 ||
+        (!m_finished && m_ready + (m_held ? 1: 0) < nslots);
+    });
+    if (m_exit)
+      break;
+
+    const uint64_t generation = m_generation;
+    const int seekFrame = m_seekFrame;
+    m_seekFrame = -1;
+    if (seekFrame >= 0) {
+      m_nextFrame = seekFrame;
+      m_finished = false;
+    }
+    const int frameIndex = m_nextFrame;
+
+    // The slot isn't visible to nextFrame() until m_ready is
+    // incremented, so we can decode the frame into it without the
+    // lock
+    const int slotIndex = (m_head + m_ready) % nslots;
+    Slot& slot = m_slots[slotIndex];
+    const Slot* lastSlot = (m_lastSlot >= 0 && m_lastSlot != slotIndex ?
+                            &m_slots[m_lastSlot]: nullptr);
+    m_lastSlot = slotIndex;
+    lock.unlock();
+
+    // Delta frames are decoded over the previous frame, so the slot
+    // must start with the last decoded pixels and palette (the slot
+    // of the previous frame cannot be re-used in place because it can
+    // be in use by the user)
+    if (lastSlot) {
+      std::copy(lastSlot->pixels.begin(), lastSlot->pixels.end(), slot.pixels.begin());
+      slot.frame.colormap = lastSlot->frame.colormap;
+    }
+
+    bool ok;
+    if (seekFrame >= 0)
+      ok = m_decoder.seekFrame(frameIndex, slot.frame);
+    else
+      ok = (frameIndex < m_header.frames &&
+            m_decoder.readFrame(slot.frame));
+    slot.index = frameIndex;
+
+    lock.lock();
+    if (generation != m_generation) // Cancelled by seekFrame()
+      continue;
+
+    if (!ok) {
+      m_finished = true;
+      m_readyCv.notify_all();
+      continue;
+    }
+    m_nextFrame = frameIndex+1;
+    ++m_ready;
+    m_readyCv.notify_all();
+  }
+}
+
+} // namespace flic
@@ -0,0 +1,146 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic_batch.h"
+#include "flic_threads.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace flic {
+
+BatchTranscoder::BatchTranscoder(int threads, size_t maxMemory)
+  : m_threadPool(new ThreadPool(threads))
+  , m_maxMemory(maxMemory)
+  , m_usedMemory(0)
+  , m_peakMemory(0)
+{
+}
+
+BatchTranscoder::~BatchTranscoder()
+{
+}
+
+std::vector<BatchTranscoder::Result> BatchTranscoder::run(const std::vector<Job>& jobs)
+{
+  // Idle threads take the next pending file, so a big file doesn't
+  // block the rest of the work
+  std::vector<Result> results(jobs.size());
+  m_peakMemory = 0;
+  m_threadPool->parallelFor(int(jobs.size()), [this, &jobs, &results](int i){
+    results[i] = transcode(jobs[i]);
+  });
+  return results;
+}
+
+BatchTranscoder::Result BatchTranscoder::transcode(const Job& job)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  Result result;
+
+  MappedFileInterface input(job.input.c_str());
+  if (!input.ok())
+    return result;
+  input.data(result.inputBytes);
+
+  Decoder decoder(&input, &m_bufferPool);
+  Header header;
+  if (!decoder.readHeader(header))
+    return result;
+
+  // Decoded frame, first frame (for the ring frame), previous frame
+  // in the encoder, and the output file (similar to the input size)
+  const size_t frameSize = size_t(header.width)*header.height;
+  const size_t memory = 3*frameSize + result.inputBytes;
+  acquireMemory(memory);
+
+  std::vector<uint8_t> pixels = m_bufferPool.take(frameSize);
+  std::vector<uint8_t> firstPixels = m_bufferPool.take(frameSize);
+  std::vector<uint8_t> output = m_bufferPool.take(result.inputBytes);
+  pixels.resize(frameSize);
+
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = header.width;
+
+  Colormap firstColormap;
+  bool ok = true;
+  {
+    MemoryFileInterface outputFile(&output);
+    Encoder encoder(&outputFile, &m_bufferPool);
+    encoder.writeHeader(header);
+
+    for (int i=0; i<header.frames && ok; ++i) {
+      ok = (decoder.readFrame(frame) && input.ok());
+      if (!ok)
+        break;
+
+      if (i == 0) {
+        firstPixels.assign(pixels.begin(), pixels.end());
+        firstColormap = frame.colormap;
+      }
+      encoder.writeFrame(frame);
+      ++result.frames;
+    }
+
+    if (ok && header.frames > 0) {
+      Frame first;
+      first.pixels = firstPixels.data();
+      first.rowstride = header.width;
+      first.colormap = firstColormap;
+      encoder.writeRingFrame(first);
+    }
+  }
+
+  if (ok) {
+    FILE* f = std::fopen(job.output.c_str(), "wb");
+    if (f) {
+      ok = (std::fwrite(output.data(), 1, output.size(), f) == output.size());
+      ok = (std::fclose(f) == 0 && ok);
+    }
+    else
+      ok = false;
+  }
+
+  result.ok = ok;
+  result.outputBytes = output.size();
+
+  m_bufferPool.release(pixels);
+  m_bufferPool.release(firstPixels);
+  m_bufferPool.release(output);
+  releaseMemory(memory);
+
+  result.seconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - t0).count();
+  return result;
+}
+
+// Waits until there is enough memory available to transcode one
+// file (a file is always processed if there are no other files in
+// process, even if it's bigger than the limit)
+void BatchTranscoder::acquireMemory(size_t size)
+{
+  std::unique_lock<std::mutex> lock(m_memoryMutex);
+  if (m_maxMemory > 0) {
+    m_memoryCv.wait(lock, [this, size]{
+      return (m_usedMemory == 0 || m_usedMemory + size <= m_maxMemory);
+    });
+  }
+  m_usedMemory += size;
+  m_peakMemory = std::max(m_peakMemory, m_usedMemory);
+}
+
+void BatchTranscoder::releaseMemory(size_t size)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_memoryMutex);
+    m_usedMemory -= size;
+  }
+  m_memoryCv.notify_all();
+}
+
+} // namespace flic
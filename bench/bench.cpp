@@ -0,0 +1,324 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+// Encoding/decoding benchmarks with synthetic animations:
+//
+//   flic-bench [section]
+//
+// Build it in Release mode (and with FLIC_STATS=ON to get the time
+// spent in each chunk type).
+
+#include "../flic.h"
+#include "../flic_details.h"
+#include "../tests/animations.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since(const Clock::time_point& t0)
+{
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double megabytes(double bytes)
+{
+  return bytes / (1024.0*1024.0);
+}
+
+const char* chunk_name(int type)
+{
+  switch (type) {
+    case FLI_COLOR_256_CHUNK: return "COLOR_256";
+    case FLI_DELTA_CHUNK:     return "DELTA";
+    case FLI_COLOR_64_CHUNK:  return "COLOR_64";
+    case FLI_LC_CHUNK:        return "LC";
+    case FLI_BLACK_CHUNK:     return "BLACK";
+    case FLI_BRUN_CHUNK:      return "BRUN";
+    case FLI_COPY_CHUNK:      return "COPY";
+  }
+  return nullptr;
+}
+
+// Returns the best time of "runs" encodings of the whole animation
+double time_encode(const Animation& anim, std::vector<uint8_t>& data, int runs = 3)
+{
+  double best = 0.0;
+  for (int run=0; run<runs; ++run) {
+    data.clear();
+    MemoryFileInterface file(&data);
+    const auto t0 = Clock::now();
+    {
+      Encoder encoder(&file);
+      encode(anim, encoder);
+    }
+    const double t = seconds_since(t0);
+    if (run == 0 || t < best)
+      best = t;
+  }
+  return best;
+}
+
+// Returns the best time of "runs" decodings of all frames
+double time_decode(const Animation& anim, const std::vector<uint8_t>& data,
+                   Stats* stats = nullptr, int runs = 3)
+{
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+  double best = 0.0;
+  for (int run=0; run<runs; ++run) {
+    MemoryFileInterface file(data.data(), data.size());
+    Decoder decoder(&file);
+    Header header;
+    decoder.readHeader(header);
+
+    Frame frame;
+    frame.pixels = pixels.data();
+    frame.rowstride = anim.width;
+
+    const auto t0 = Clock::now();
+    for (int i=0; i<header.frames; ++i)
+      decoder.readFrame(frame);
+    const double t = seconds_since(t0);
+    if (run == 0 || t < best) {
+      best = t;
+      if (stats)
+        *stats = decoder.stats();
+    }
+  }
+  return best;
+}
+
+// Encodes/decodes each scenario at several resolutions
+void bench_scenarios()
+{
+  const int sizes[][3] = {     // Width, height, frames
+    { 320, 200, 32 },
+    { 640, 480, 16 },
+    { 1920, 1080, 8 },
+  };
+  const Scenario scenarios[] = {
+    Noise, Flat, Sprite, PaletteCycling, SceneCuts, Runs, BlackFrames,
+  };
+
+  std::printf("%-9s %9s %10s %6s %9s %8s %9s %8s  %s\n",
+              "scenario", "size", "bytes", "ratio",
+              "enc MB/s", "enc f/s", "dec MB/s", "dec f/s", "chunks");
+
+  for (const auto& size : sizes) {
+    for (Scenario scenario : scenarios) {
+      const Animation anim = make_animation(scenario, size[0], size[1], size[2]);
+      const double rawBytes = double(anim.width)*anim.height*anim.frames();
+
+      std::vector<uint8_t> data;
+      Stats stats;
+      const double encodeTime = time_encode(anim, data);
+      const double decodeTime = time_decode(anim, data, &stats);
+
+      // Chunk types used in the file
+      std::vector<FrameInfo> frames;
+      {
+        MemoryFileInterface file(data.data(), data.size());
+        Decoder decoder(&file);
+        Header header;
+        decoder.probe(header, frames);
+      }
+      int chunks[Stats::kChunkTypes] = { 0 };
+      for (const FrameInfo& frame : frames)
+        for (const ChunkInfo& chunk : frame.chunks)
+          if (chunk.type < Stats::kChunkTypes)
+            ++chunks[chunk.type];
+
+      char sizeText[32];
+      std::snprintf(sizeText, sizeof(sizeText), "%dx%d", anim.width, anim.height);
+      std::printf("%-9s %9s %10zu %6.3f %9.1f %8.1f %9.1f %8.1f ",
+                  scenario_name(scenario), sizeText, data.size(),
+                  double(data.size()) / rawBytes,
+                  megabytes(rawBytes) / encodeTime, anim.frames() / encodeTime,
+                  megabytes(rawBytes) / decodeTime, anim.frames() / decodeTime);
+      for (int type=0; type<Stats::kChunkTypes; ++type) {
+        const char* name = chunk_name(type);
+        if (name && chunks[type] > 0)
+          std::printf(" %s:%d", name, chunks[type]);
+      }
+      std::printf("\n");
+
+      // Decoding speed of each chunk type (only with FLIC_STATS)
+      for (int type=0; type<Stats::kChunkTypes; ++type) {
+        const Stats::ChunkStats& chunk = stats.chunks[type];
+        const char* name = chunk_name(type);
+        if (name && chunk.seconds > 0.0) {
+          std::printf("%38s %-9s %9.1f MB/s (chunk data)\n", "",
+                      name, megabytes(double(chunk.bytes)) / chunk.seconds);
+        }
+      }
+    }
+  }
+}
+
+// Time to encode one keyframe (which is BRUN-compressed) as the
+// width grows, it should grow linearly with the width
+void bench_brun_widths()
+{
+  const int widths[] = { 320, 640, 1280, 1920, 2560, 3840 };
+  const int height = 200;
+  const Scenario scenarios[] = { Runs, Noise, Flat };
+
+  std::printf("%6s", "width");
+  for (Scenario scenario : scenarios) {
+    char ms[32], mbs[32];
+    std::snprintf(ms, sizeof(ms), "%s ms", scenario_name(scenario));
+    std::snprintf(mbs, sizeof(mbs), "%s MB/s", scenario_name(scenario));
+    std::printf(" %12s %13s", ms, mbs);
+  }
+  std::printf("\n");
+
+  for (int width : widths) {
+    std::printf("%6d", width);
+    for (Scenario scenario : scenarios) {
+      const Animation anim = make_animation(scenario, width, height, 1);
+      std::vector<uint8_t> data;
+      const double t = time_encode(anim, data, 5);
+      std::printf(" %12.3f %13.1f",
+                  t * 1000.0, megabytes(double(width)*height) / t);
+    }
+    std::printf("\n");
+  }
+}
+
+// Decoding speed of large keyframes (BRUN chunks), the time is
+// dominated by the fill/copy of each run
+void bench_brun_decode()
+{
+  const int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+  const Scenario scenarios[] = { Runs, Sprite };
+
+  std::printf("%-9s %9s %8s %10s %10s\n",
+              "scenario", "size", "chunk", "ms", "MB/s");
+
+  for (const auto& size : sizes) {
+    for (Scenario scenario : scenarios) {
+      const Animation anim = make_animation(scenario, size[0], size[1], 1);
+      std::vector<uint8_t> data;
+      time_encode(anim, data, 1);
+
+      std::vector<FrameInfo> frames;
+      {
+        MemoryFileInterface file(data.data(), data.size());
+        Decoder decoder(&file);
+        Header header;
+        decoder.probe(header, frames);
+      }
+      const char* name = "?";
+      for (const ChunkInfo& chunk : frames[0].chunks)
+        if (chunk.type != FLI_COLOR_256_CHUNK && chunk_name(chunk.type))
+          name = chunk_name(chunk.type);
+
+      const double t = time_decode(anim, data, nullptr, 10);
+      char sizeText[32];
+      std::snprintf(sizeText, sizeof(sizeText), "%dx%d", anim.width, anim.height);
+      std::printf("%-9s %9s %8s %10.3f %10.1f\n",
+                  scenario_name(scenario), sizeText, name, t * 1000.0,
+                  megabytes(double(anim.width)*anim.height) / t);
+    }
+  }
+}
+
+// Random access with Decoder::seekFrame() in long animations, with
+// and without the snapshot cache
+void bench_seek()
+{
+  const int nframes = 1000;
+  const int nseeks = 200;
+  const Scenario scenarios[] = { Sprite, SceneCuts };
+  const int intervals[] = { 0, 100, 25 };
+
+  std::printf("%-9s %10s %9s %10s %10s\n",
+              "scenario", "index ms", "snapshot", "avg ms", "max ms");
+
+  for (Scenario scenario : scenarios) {
+    const Animation anim = make_animation(scenario, 320, 200, nframes);
+    std::vector<uint8_t> data;
+    time_encode(anim, data, 1);
+
+    double indexTime;
+    {
+      MemoryFileInterface file(data.data(), data.size());
+      Decoder decoder(&file);
+      Header header;
+      decoder.readHeader(header);
+      const auto t0 = Clock::now();
+      decoder.buildIndex();
+      indexTime = seconds_since(t0);
+    }
+
+    for (int interval : intervals) {
+      MemoryFileInterface file(data.data(), data.size());
+      Decoder decoder(&file);
+      Header header;
+      decoder.readHeader(header);
+      decoder.buildIndex();
+      if (interval > 0)
+        decoder.setSnapshotCache(interval);
+
+      std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+      Frame frame;
+      frame.pixels = pixels.data();
+      frame.rowstride = anim.width;
+
+      Random rnd(interval + 1);
+      double total = 0.0, worst = 0.0;
+      for (int i=0; i<nseeks; ++i) {
+        const int frameIndex = rnd.next(nframes);
+        const auto t0 = Clock::now();
+        decoder.seekFrame(frameIndex, frame);
+        const double t = seconds_since(t0);
+        total += t;
+        worst = std::max(worst, t);
+      }
+
+      char snapshot[32] = "none";
+      if (interval > 0)
+        std::snprintf(snapshot, sizeof(snapshot), "%d", interval);
+      std::printf("%-9s %10.3f %9s %10.3f %10.3f\n",
+                  scenario_name(scenario), indexTime * 1000.0, snapshot,
+                  total * 1000.0 / nseeks, worst * 1000.0);
+    }
+  }
+}
+
+struct Section {
+  const char* name;
+  void (*func)();
+} sections[] = {
+  { "scenarios", bench_scenarios },
+  { "brun-widths", bench_brun_widths },
+  { "brun-decode", bench_brun_decode },
+  { "seek", bench_seek },
+};
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  for (const Section& section : sections) {
+    if (argc > 1 && std::strcmp(argv[1], section.name) != 0)
+      continue;
+
+    std::printf("== %s\n", section.name);
+    section.func();
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -1,5 +1,5 @@
 // Aseprite FLIC Library
-// Copyright (c) 2019-2025 Igara Studio S.A.
+// Copyright (c) 2019-2026 Igara Studio S.A.
 // Copyright (c) 2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -7,25 +7,147 @@
 
 #include "flic.h"
 #include "flic_details.h"
+#include "flic_kernels.h"
+#include "flic_stats.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <limits>
+#include <utility>
 
 #undef assert
 #define assert(...)
 
 namespace flic {
 
-Decoder::Decoder(FileInterface* file)
+// Fills "n" bytes with the given color (short runs are common, so we
+// avoid the memset() call for them)
+static inline void fill_bytes(uint8_t* it, uint8_t color, int n)
+{
+  if (n <= 8) {
+    for (int i=0; i<n; ++i)
+      it[i] = color;
+  }
+  else
+    std::memset(it, color, n);
+}
+
+// Fills "n" bytes repeating the pair of bytes color1/color2
+static void fill_words(uint8_t* it, uint8_t color1, uint8_t color2, int n)
+{
+  if (color1 == color2) {
+    fill_bytes(it, color1, n);
+    return;
+  }
+
+  if (n > 0) it[0] = color1;
+  if (n > 1) it[1] = color2;
+
+  // Duplicate the filled part (which contains an even number of
+  // bytes) until we complete the "n" bytes
+  int filled = std::min(n, 2);
+  while (filled < n) {
+    int m = std::min(filled, n-filled);
+    std::memcpy(it+filled, it, m);
+    filled += m;
+  }
+}
+
+// Reads the data of one chunk from memory
+class Decoder::ChunkReader {
+public:
+  ChunkReader(const uint8_t* data, size_t size)
+    : m_it(data)
+    , m_end(data+size)
+    , m_ok(true) {
+  }
+
+  // Returns false if we tried to read beyond the end of the chunk
+  bool ok() const {
+    return m_ok;
+  }
+
+  uint8_t read8() {
+    if (m_it < m_end)
+      return *(m_it++);
+
+    m_ok = false;
+    return 0;
+  }
+
+  uint16_t read16() {
+    int b1 = read8();
+    int b2 = read8();
+
+    if (m_ok)
+      return ((b2 << 8) | b1); // Little endian
+    else
+      return 0;
+  }
+
+  void read(uint8_t* buf, size_t n) {
+    size_t available = std::min<size_t>(n, m_end - m_it);
+    std::copy(m_it, m_it+available, buf);
+    m_it += available;
+    if (available < n) {
+      std::fill(buf+available, buf+n, 0);
+      m_ok = false;
+    }
+  }
+
+  void skip(size_t n) {
+    size_t available = std::min<size_t>(n, m_end - m_it);
+    m_it += available;
+    if (available < n)
+      m_ok = false;
+  }
+
+private:
+  const uint8_t* m_it;
+  const uint8_t* m_end;
+  bool m_ok;
+};
+
+Decoder::Decoder(FileInterface* file, BufferPool* pool)
   : m_file(file)
+  , m_pool(pool)
+  , m_fileSize(0)
+  , m_frames(0)
   , m_frameCount(0)
   , m_offsetFrame1(0)
   , m_offsetFrame2(0)
+  , m_snapshotInterval(0)
+  , m_snapshotMaxBytes(0)
+  , m_snapshotUse(0)
+  , m_trackChanges(false)
+  , m_outputPixels(nullptr)
+  , m_outputRowstride(0)
+  , m_outputFormat(PixelFormat::RGBA8)
+  , m_outputPaletteValid(false)
+  , m_roiY0(0)
+  , m_roiY1(0)
+  , m_validY0(0)
+  , m_validY1(std::numeric_limits<int>::max())
 {
+#if FLIC_STATS
+  m_statsFile.reset(new StatsFileInterface(file, m_stats));
+  m_file = m_statsFile.get();
+#endif
+}
+
+Decoder::~Decoder()
+{
+  if (m_pool) {
+    m_pool->release(m_chunkData);
+    for (Snapshot& snapshot : m_snapshots)
+      m_pool->release(snapshot.pixels);
+  }
 }
 
 bool Decoder::readHeader(Header& header)
 {
-  read32(); // file size
+  m_fileSize = read32();
   uint16_t magic = read16();
 
   assert(magic == FLI_MAGIC_NUMBER || magic == FLC_MAGIC_NUMBER);
@@ -58,6 +180,15 @@ bool Decoder::readHeader(Header& header)
 
   m_width = header.width;
   m_height = header.height;
+  m_frames = header.frames;
+  m_validY0 = 0;
+  m_validY1 = m_height;
+  updateRoiRows();
+
+  // Chunks are loaded in m_chunkData only if the file isn't in memory
+  size_t fileSize;
+  if (m_pool && !m_file->data(fileSize) && m_chunkData.capacity() == 0)
+    m_chunkData = m_pool->take(size_t(m_width)*m_height);
 
   // Skip padding
   m_file->seek(128);
@@ -66,17 +197,401 @@ bool Decoder::readHeader(Header& header)
 
 bool Decoder::readFrame(Frame& frame)
 {
-  switch (m_frameCount) {
-    case 0:
-      if (m_offsetFrame1)
-        m_file->seek(m_offsetFrame1);
+  if (!readNextFrame(frame))
+    return false;
+
+  FLIC_STATS_ADD(m_stats.frames, 1);
+  if (m_outputPixels)
+    convertOutput(frame);
+  return true;
+}
+
+void Decoder::setOutput(uint8_t* pixels, int rowstride, PixelFormat format)
+{
+  m_outputPixels = pixels;
+  m_outputRowstride = rowstride;
+  m_outputFormat = format;
+  m_outputPaletteValid = false;
+  if (pixels)
+    m_trackChanges = true;
+}
+
+void Decoder::setRegionOfInterest(const Rect& rc)
+{
+  m_roi = rc;
+  updateRoiRows();
+}
+
+void Decoder::updateRoiRows()
+{
+  if (m_roi.isEmpty()) {
+    m_roiY0 = 0;
+    m_roiY1 = m_height;
+  }
+  else {
+    m_roiY0 = std::max(0, std::min(m_roi.y, m_height));
+    m_roiY1 = std::max(m_roiY0, std::min(m_roi.y+m_roi.h, m_height));
+  }
+}
+
+// Returns true if the frame pixels of all rows in the region of
+// interest are up to date
+bool Decoder::roiRowsValid() const
+{
+  return (m_roiY0 >= m_roiY1 ||
+          (m_validY0 <= m_roiY0 && m_roiY1 <= m_validY1));
+}
+
+bool Decoder::readNextFrame(Frame& frame)
+{
+  if (m_frameCount < int(m_index.size())) {
+    m_file->seek(m_index[m_frameCount].offset);
+  }
+  else {
+    switch (m_frameCount) {
+      case 0:
+        if (m_offsetFrame1)
+          m_file->seek(m_offsetFrame1);
+        break;
+      case 1:
+        if (m_offsetFrame2)
+          m_file->seek(m_offsetFrame2);
+        break;
+    }
+  }
+
+  if (m_trackChanges) {
+    m_changes.colormapChanged = false;
+    m_changes.rows.assign(m_height, Span());
+  }
+
+  // Rows outside the region of interest will not be updated (a
+  // keyframe chunk resets the valid rows to the region)
+  m_validY0 = std::max(m_validY0, m_roiY0);
+  m_validY1 = std::max(m_validY0, std::min(m_validY1, m_roiY1));
+
+  readFrameData(frame, false);
+  ++m_frameCount;
+
+  if (m_trackChanges)
+    updateChangedBounds();
+
+  if (m_snapshotInterval > 0 &&
+      (m_frameCount-1) % m_snapshotInterval == 0)
+    storeSnapshot(frame);
+  return true;
+}
+
+void Decoder::setTrackChanges(bool state)
+{
+  // The output conversion needs the changes
+  m_trackChanges = (state || m_outputPixels);
+  m_changes = FrameChanges();
+}
+
+void Decoder::setSnapshotCache(int interval, size_t maxBytes)
+{
+  m_snapshotInterval = interval;
+  m_snapshotMaxBytes = maxBytes;
+  if (interval <= 0) {
+    if (m_pool) {
+      for (Snapshot& snapshot : m_snapshots)
+        m_pool->release(snapshot.pixels);
+    }
+    m_snapshots.clear();
+  }
+}
+
+bool Decoder::probe(Header& header, std::vector<FrameInfo>& frames)
+{
+  // readHeader() resets the rows that are valid in the current frame
+  // (it starts a new decoding), but probe() must keep the decoding
+  // state as it is
+  const size_t restorePos = m_file->tell();
+  const int validY0 = m_validY0;
+  const int validY1 = m_validY1;
+  m_file->seek(0);
+  const bool ok = readHeader(header);
+  m_validY0 = validY0;
+  m_validY1 = validY1;
+  if (!ok) {
+    m_file->seek(restorePos);
+    return false;
+  }
+
+  readFrameInfos(frames);
+  if (m_index.empty())
+    fillIndex(frames);
+
+  m_file->seek(restorePos);
+  return (int(frames.size()) >= m_frames);
+}
+
+bool Decoder::buildIndex()
+{
+  if (m_index.empty()) {
+    const size_t restorePos = m_file->tell();
+    std::vector<FrameInfo> frames;
+    readFrameInfos(frames);
+    fillIndex(frames);
+    m_file->seek(restorePos);
+  }
+  return (int(m_index.size()) >= m_frames);
+}
+
+void Decoder::readFrameInfos(std::vector<FrameInfo>& frames)
+{
+  frames.clear();
+  uint32_t pos = (m_offsetFrame1 ? m_offsetFrame1: 128);
+
+  // We include the ring frame (the extra frame used to loop the
+  // animation) only if the file size says that it's there, so we
+  // don't read beyond the end of the file. Files written in one pass
+  // (to a non-seekable file) have no file size, in that case we use
+  // the size of the file in memory, or just check if the next frame
+  // header can be read.
+  size_t fileSize = m_fileSize;
+  if (fileSize == 0)
+    m_file->data(fileSize);
+
+  for (int i=0; i<=m_frames; ++i) {
+    if (i == 1 && m_offsetFrame2)
+      pos = m_offsetFrame2;
+    if (i == m_frames && fileSize > 0 && pos+16 > fileSize)
       break;
-    case 1:
-      if (m_offsetFrame2)
-        m_file->seek(m_offsetFrame2);
+
+    m_file->seek(pos);
+    uint32_t frameSize = read32();
+    uint16_t magic = read16();
+    uint16_t chunks = read16();
+    if (!m_file->ok() ||
+        magic != FLI_FRAME_MAGIC_NUMBER ||
+        frameSize < 16)
       break;
+
+    FrameInfo info;
+    info.offset = pos;
+    info.size = frameSize;
+    info.keyframe = (i == 0);
+    info.colorChunk = false;
+
+    // Walk the chunk headers (without reading the chunk data)
+    uint32_t chunkPos = pos+16;
+    for (uint16_t j=0; j<chunks && chunkPos+6 <= pos+frameSize; ++j) {
+      m_file->seek(chunkPos);
+      ChunkInfo chunk;
+      chunk.offset = chunkPos;
+      chunk.size = read32();
+      chunk.type = read16();
+      if (!m_file->ok() || chunk.size < 6)
+        break;
+
+      switch (chunk.type) {
+        case FLI_COLOR_256_CHUNK:
+        case FLI_COLOR_64_CHUNK:
+          info.colorChunk = true;
+          break;
+        case FLI_BLACK_CHUNK:
+        case FLI_BRUN_CHUNK:
+        case FLI_COPY_CHUNK:
+          info.keyframe = true;
+          break;
+      }
+      info.chunks.push_back(chunk);
+      chunkPos += chunk.size;
+    }
+
+    frames.push_back(std::move(info));
+    pos += frameSize;
   }
+}
 
+void Decoder::fillIndex(const std::vector<FrameInfo>& frames)
+{
+  m_index.resize(frames.size());
+  for (size_t i=0; i<frames.size(); ++i) {
+    m_index[i].offset = frames[i].offset;
+    m_index[i].keyframe = frames[i].keyframe;
+    m_index[i].colorChunk = frames[i].colorChunk;
+  }
+}
+
+bool Decoder::seekFrame(int frameIndex, Frame& frame)
+{
+  buildIndex();
+  if (frameIndex < 0 || frameIndex >= int(m_index.size()))
+    return false;
+
+  // Nearest keyframe (a frame that replaces all pixels)
+  int keyframe = frameIndex;
+  while (keyframe > 0 && !m_index[keyframe].keyframe)
+    --keyframe;
+
+  // Nearest snapshot (it's useful only if it's after the keyframe)
+  Snapshot* snapshot = findSnapshot(frameIndex, frame);
+  if (snapshot && snapshot->frame < keyframe)
+    snapshot = nullptr;
+  const int start = (snapshot ? snapshot->frame: keyframe);
+
+  // If the frame was already decoded, or we can reach the requested
+  // frame from the current one without passing through a keyframe
+  // or snapshot, we just continue decoding from the current frame.
+  const int current = m_frameCount-1;
+  if (current >= start && current <= frameIndex && roiRowsValid()) {
+    // Do nothing
+  }
+  else if (snapshot) {
+    std::copy(snapshot->pixels.begin(), snapshot->pixels.end(), frame.pixels);
+    frame.colormap = snapshot->colormap;
+    snapshot->lastUse = ++m_snapshotUse;
+    m_validY0 = snapshot->validY0;
+    m_validY1 = snapshot->validY1;
+
+    m_frameCount = snapshot->frame+1;
+  }
+  else {
+    // Restore the palette applying all color chunks before the
+    // keyframe (starting from the current frame if it's possible).
+    // From the first frame, we start with a black palette, as the
+    // first color chunk can leave some colors unchanged.
+    int i = (current < keyframe ? current+1: 0);
+    if (i == 0)
+      frame.colormap = Colormap();
+    for (; i<keyframe; ++i) {
+      if (m_index[i].colorChunk) {
+        m_file->seek(m_index[i].offset);
+        readFrameData(frame, true);
+      }
+    }
+    m_frameCount = keyframe;
+    m_validY0 = 0;
+    m_validY1 = m_height;
+  }
+
+  while (m_frameCount <= frameIndex) {
+    if (!readNextFrame(frame))
+      return false;
+  }
+
+  // The whole frame can be different from the previous one
+  if (m_trackChanges) {
+    m_changes.colormapChanged = true;
+    markAllChanged();
+  }
+
+  // Frames decoded to reach this one are not counted
+  FLIC_STATS_ADD(m_stats.frames, 1);
+  if (m_outputPixels)
+    convertOutput(frame);
+  return true;
+}
+
+Decoder::Snapshot* Decoder::findSnapshot(int frameIndex, const Frame& frame)
+{
+  Snapshot* best = nullptr;
+  for (Snapshot& snapshot : m_snapshots) {
+    if (snapshot.frame <= frameIndex &&
+        snapshot.pixels.size() == frame.rowstride*m_height &&
+        (m_roiY0 >= m_roiY1 ||
+         (snapshot.validY0 <= m_roiY0 && m_roiY1 <= snapshot.validY1)) &&
+        (!best || best->frame < snapshot.frame))
+      best = &snapshot;
+  }
+  return best;
+}
+
+void Decoder::storeSnapshot(const Frame& frame)
+{
+  const int frameIndex = m_frameCount-1;
+  const size_t size = frame.rowstride*m_height;
+  if (m_snapshotMaxBytes > 0 && size > m_snapshotMaxBytes)
+    return;
+
+  size_t total = 0;
+  Snapshot* snapshot = nullptr;
+  for (Snapshot& s : m_snapshots) {
+    if (s.frame == frameIndex) {
+      // Already stored (with the same or more valid rows)
+      if (s.validY0 <= m_validY0 && m_validY1 <= s.validY1)
+        return;
+      snapshot = &s;
+    }
+    total += s.pixels.size();
+  }
+
+  // Re-use the least recently used snapshot if we don't have more
+  // memory available
+  if (!snapshot && m_snapshotMaxBytes > 0 && total+size > m_snapshotMaxBytes) {
+    for (Snapshot& s : m_snapshots) {
+      if (!snapshot || snapshot->lastUse > s.lastUse)
+        snapshot = &s;
+    }
+  }
+  if (!snapshot) {
+    m_snapshots.push_back(Snapshot());
+    snapshot = &m_snapshots.back();
+    if (m_pool)
+      snapshot->pixels = m_pool->take(size);
+  }
+
+  snapshot->frame = frameIndex;
+  snapshot->lastUse = ++m_snapshotUse;
+  snapshot->validY0 = m_validY0;
+  snapshot->validY1 = m_validY1;
+  snapshot->pixels.assign(frame.pixels, frame.pixels+size);
+  snapshot->colormap = frame.colormap;
+}
+
+// Converts the changed pixels (or all pixels if the palette changed)
+// to the output format
+void Decoder::convertOutput(const Frame& frame)
+{
+  bool all = false;
+  if (m_changes.colormapChanged || !m_outputPaletteValid) {
+    for (int i=0; i<Colormap::SIZE; ++i) {
+      const Color c = frame.colormap[i];
+      switch (m_outputFormat) {
+        case PixelFormat::RGBA8:
+        case PixelFormat::BGRA8: {
+          // Packed in memory order, so it works in any endianness
+          const uint8_t rgba[4] = {
+            (m_outputFormat == PixelFormat::RGBA8 ? c.r: c.b), c.g,
+            (m_outputFormat == PixelFormat::RGBA8 ? c.b: c.r), 255 };
+          std::memcpy(&m_outputPalette[i], rgba, 4);
+          break;
+        }
+        case PixelFormat::RGB565:
+          m_outputPalette[i] = ((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3);
+          break;
+      }
+    }
+    m_outputPaletteValid = true;
+    all = true;
+  }
+
+  for (int y=m_roiY0; y<m_roiY1; ++y) {
+    int x0 = 0, x1 = m_width;
+    if (!all) {
+      x0 = m_changes.rows[y].x0;
+      x1 = m_changes.rows[y].x1;
+      if (x0 >= x1)
+        continue;
+    }
+
+    const uint8_t* src = frame.pixels + y*frame.rowstride + x0;
+    uint8_t* dst = m_outputPixels + y*m_outputRowstride;
+    if (m_outputFormat == PixelFormat::RGB565) {
+      uint16_t* dst16 = ((uint16_t*)dst) + x0;
+      for (int x=x0; x<x1; ++x)
+        *(dst16++) = uint16_t(m_outputPalette[*(src++)]);
+    }
+    else
+      lookup32(src, ((uint32_t*)dst) + x0, x1-x0, m_outputPalette);
+  }
+}
+
+void Decoder::readFrameData(Frame& frame, bool onlyColors)
+{
   uint32_t frameStartPos = m_file->tell();
   uint32_t frameSize = read32();
   uint16_t magic = read16();
@@ -87,64 +602,188 @@ bool Decoder::readFrame(Frame& frame)
   for (int i=0; i<8; ++i)       // Padding
     m_file->read8();
 
+  FLIC_STATS_ADD(m_stats.frameBytes, frameSize);
+
   for (uint16_t i=0; i!=chunks; ++i)
-    readChunk(frame);
+    readChunk(frame, onlyColors);
 
   m_file->seek(frameStartPos+frameSize);
-  ++m_frameCount;
-  return true;
 }
 
-void Decoder::readChunk(Frame& frame)
+void Decoder::readChunk(Frame& frame, bool onlyColors)
 {
   uint32_t chunkStartPos = m_file->tell();
   uint32_t chunkSize = read32();
   uint16_t type = read16();
 
+  if (onlyColors &&
+      type != FLI_COLOR_256_CHUNK &&
+      type != FLI_COLOR_64_CHUNK)
+    type = 0;                   // Skip this chunk
+
+#if FLIC_STATS
+  const StatsTime t0 = stats_now();
+#endif
+
   switch (type) {
-    case FLI_COLOR_256_CHUNK: readColorChunk(frame, false); break;
-    case FLI_DELTA_CHUNK:     readDeltaChunk(frame);        break;
-    case FLI_COLOR_64_CHUNK:  readColorChunk(frame, true);  break;
-    case FLI_LC_CHUNK:        readLcChunk(frame);           break;
-    case FLI_BLACK_CHUNK:     readBlackChunk(frame);        break;
-    case FLI_BRUN_CHUNK:      readBrunChunk(frame);         break;
-    case FLI_COPY_CHUNK:      readCopyChunk(frame);         break;
+    case FLI_COLOR_256_CHUNK:
+    case FLI_DELTA_CHUNK:
+    case FLI_COLOR_64_CHUNK:
+    case FLI_LC_CHUNK:
+    case FLI_BRUN_CHUNK:
+    case FLI_COPY_CHUNK: {
+      ChunkReader in = readChunkData(chunkSize > 6 ? chunkSize-6: 0);
+      switch (type) {
+        case FLI_COLOR_256_CHUNK: readColorChunk(frame, in, false); break;
+        case FLI_DELTA_CHUNK:     readDeltaChunk(frame, in);        break;
+        case FLI_COLOR_64_CHUNK:  readColorChunk(frame, in, true);  break;
+        case FLI_LC_CHUNK:        readLcChunk(frame, in);           break;
+        case FLI_BRUN_CHUNK:      readBrunChunk(frame, in);         break;
+        case FLI_COPY_CHUNK:      readCopyChunk(frame, in);         break;
+      }
+      break;
+    }
+    case FLI_BLACK_CHUNK:
+      readBlackChunk(frame);
+      break;
     default:
       // Ignore all other kind of chunks
       break;
   }
 
+#if FLIC_STATS
+  if (type < Stats::kChunkTypes) {
+    // Packets were already added by the chunk decoder
+    add_chunk_stats(m_stats, type, chunkSize, 0, stats_seconds_since(t0));
+  }
+#endif
+
+  if (m_trackChanges) {
+    switch (type) {
+      case FLI_COLOR_256_CHUNK:
+      case FLI_COLOR_64_CHUNK:
+        m_changes.colormapChanged = true;
+        break;
+      case FLI_BRUN_CHUNK:
+      case FLI_COPY_CHUNK:
+      case FLI_BLACK_CHUNK:
+        markAllChanged();
+        break;
+    }
+  }
+
   m_file->seek(chunkStartPos+chunkSize);
 }
 
+void Decoder::markChanged(int y, int x0, int x1)
+{
+  x0 = std::max(x0, 0);
+  x1 = std::min(x1, m_width);
+  if (x0 >= x1 || y < 0 || y >= int(m_changes.rows.size()))
+    return;
+
+  Span& span = m_changes.rows[y];
+  if (span.x0 == span.x1) {
+    span.x0 = x0;
+    span.x1 = x1;
+  }
+  else {
+    span.x0 = std::min(span.x0, x0);
+    span.x1 = std::max(span.x1, x1);
+  }
+}
+
+// Marks all pixels in the region of interest as changed
+void Decoder::markAllChanged()
+{
+  Span span;
+  span.x0 = 0;
+  span.x1 = m_width;
+  m_changes.rows.assign(m_height, Span());
+  std::fill(m_changes.rows.begin()+m_roiY0,
+            m_changes.rows.begin()+m_roiY1, span);
+  if (m_roiY0 < m_roiY1)
+    m_changes.bounds = Rect(0, m_roiY0, m_width, m_roiY1-m_roiY0);
+  else
+    m_changes.bounds = Rect();
+}
+
+void Decoder::updateChangedBounds()
+{
+  int x0 = m_width, x1 = 0;
+  int y0 = m_height, y1 = 0;
+  for (int y=0; y<int(m_changes.rows.size()); ++y) {
+    const Span& span = m_changes.rows[y];
+    if (span.x0 < span.x1) {
+      x0 = std::min(x0, span.x0);
+      x1 = std::max(x1, span.x1);
+      y0 = std::min(y0, y);
+      y1 = y+1;
+    }
+  }
+  if (x0 < x1)
+    m_changes.bounds = Rect(x0, y0, x1-x0, y1-y0);
+  else
+    m_changes.bounds = Rect();
+}
+
+Decoder::ChunkReader Decoder::readChunkData(size_t size)
+{
+  // If the whole file is in memory, we can read the chunk data
+  // directly from there without copying it.
+  size_t fileSize;
+  if (const uint8_t* data = m_file->data(fileSize)) {
+    size_t pos = std::min(m_file->tell(), fileSize);
+    return ChunkReader(data+pos, std::min(size, fileSize-pos));
+  }
+
+  // Read the data in blocks so a broken chunk size doesn't make us
+  // allocate more memory than the available bytes in the file.
+  const size_t kBlockSize = 64*1024;
+  size_t read = 0;
+  while (read < size && m_file->ok()) {
+    size_t n = std::min(size-read, kBlockSize);
+    if (m_chunkData.size() < read+n)
+      m_chunkData.resize(read+n);
+    m_file->read(&m_chunkData[read], n);
+    read += n;
+  }
+  return ChunkReader(m_chunkData.data(), read);
+}
+
 void Decoder::readBlackChunk(Frame& frame)
 {
-  std::fill(frame.pixels,
-            frame.pixels+frame.rowstride*m_height, 0);
+  std::fill(frame.pixels+frame.rowstride*m_roiY0,
+            frame.pixels+frame.rowstride*m_roiY1, 0);
+  m_validY0 = m_roiY0;
+  m_validY1 = m_roiY1;
 }
 
-void Decoder::readCopyChunk(Frame& frame)
+void Decoder::readCopyChunk(Frame& frame, ChunkReader& in)
 {
   assert(m_width == 320 && m_height == 200);
   if (m_width == 320 && m_height == 200) {
-    for (int y=0; y<200; ++y) {
-      uint8_t* it = frame.pixels + y*frame.rowstride;
-      for (int x=0; x<320; ++x, ++it)
-        *it = m_file->read8();
+    in.skip(320*m_roiY0);
+    for (int y=m_roiY0; y<m_roiY1; ++y) {
+      in.read(frame.pixels + y*frame.rowstride, 320);
     }
+    m_validY0 = m_roiY0;
+    m_validY1 = m_roiY1;
   }
 }
 
-void Decoder::readColorChunk(Frame& frame, bool oldColorChunk)
+void Decoder::readColorChunk(Frame& frame, ChunkReader& in, bool oldColorChunk)
 {
-  int npackets = read16();
+  int npackets = in.read16();
+  FLIC_STATS_ADD(m_stats.chunks[oldColorChunk ? FLI_COLOR_64_CHUNK:
+                                                FLI_COLOR_256_CHUNK].packets, npackets);
 
   // For each packet
   int i = 0;
   while (npackets--) {
-    i += m_file->read8();       // Colors to skip
+    i += in.read8();       // Colors to skip
 
-    int colors = m_file->read8();
+    int colors = in.read8();
     if (colors == 0)
       colors = 256;
 
@@ -154,102 +793,144 @@ void Decoder::readColorChunk(Frame& frame, bool oldColorChunk)
            && i+j < 256;
          ++j) {
       Color& color = frame.colormap[i+j];
-      color.r = m_file->read8();
-      color.g = m_file->read8();
-      color.b = m_file->read8();
+      color.r = in.read8();
+      color.g = in.read8();
+      color.b = in.read8();
       if (oldColorChunk) {
         color.r = 255 * int(color.r) / 63;
         color.g = 255 * int(color.g) / 63;
         color.b = 255 * int(color.b) / 63;
       }
     }
+
+    // The skip of the next packet is relative to the last color
+    i += colors;
   }
 }
 
-void Decoder::readBrunChunk(Frame& frame)
+void Decoder::readBrunChunk(Frame& frame, ChunkReader& in)
 {
-  for (int y=0; y<m_height; ++y) {
+  m_validY0 = m_roiY0;
+  m_validY1 = m_roiY1;
+
+  // Rows after the region of interest aren't read, and rows before
+  // it are parsed (to find where the next row starts) but not expanded
+  for (int y=0; y<m_roiY1; ++y) {
+    const bool skipRow = (y < m_roiY0);
     uint8_t* it = frame.pixels+frame.rowstride*y;
     int x = 0;
-    int npackets = m_file->read8(); // Use the number of packet to check integrity
+    int npackets = in.read8(); // Use the number of packet to check integrity
     if (npackets == 0) {
       // If npackets is 0, we are in a FLC file (not FLI) and there
       // can be more than 255 packets.
       npackets = std::numeric_limits<int>::max();
     }
-    while (m_file->ok() && npackets-- != 0 && x < m_width) {
-      int count = int(int8_t(m_file->read8()));
+    while (in.ok() && npackets-- != 0 && x < m_width) {
+      FLIC_STATS_ADD(m_stats.chunks[FLI_BRUN_CHUNK].packets, 1);
+      int count = int(int8_t(in.read8()));
       if (count >= 0) {
-        uint8_t color = m_file->read8();
-        while (count-- != 0 && x < m_width) {
-          *it = color;
-          ++it;
-          ++x;
-        }
+        uint8_t color = in.read8();
+        count = std::min(count, m_width - x);
+        if (!skipRow)
+          fill_bytes(it, color, count);
+        it += count;
+        x += count;
       }
       else {
-        while (count++ != 0 && x < m_width) {
-          *it = m_file->read8();
-          ++it;
-          ++x;
-        }
+        count = std::min(-count, m_width - x);
+        if (skipRow)
+          in.skip(count);
+        else
+          in.read(it, count);
+        it += count;
+        x += count;
       }
     }
   }
 }
 
-void Decoder::readLcChunk(Frame& frame)
+void Decoder::readLcChunk(Frame& frame, ChunkReader& in)
 {
-  int skipLines = read16();
-  int nlines = read16();
+  int skipLines = in.read16();
+  int nlines = in.read16();
 
   for (int y=skipLines; y<skipLines+nlines; ++y) {
     // Break in case of invalid data
     if (y < 0 || y >= m_height)
       break;
 
+    // Rows outside the region of interest are parsed but not written
+    if (y >= m_roiY1)
+      break;
+    const bool skipRow = (y < m_roiY0);
+
     uint8_t* it = frame.pixels+frame.rowstride*y;
     int x = 0;
-    int npackets = m_file->read8();
+    int changedX0 = m_width;    // Changed pixels in this line
+    int changedX1 = 0;
+    int npackets = in.read8();
     while (npackets-- && x < m_width) {
-      int skip = m_file->read8();
+      FLIC_STATS_ADD(m_stats.chunks[FLI_LC_CHUNK].packets, 1);
+      int skip = in.read8();
 
       x += skip;
       it += skip;
 
-      int count = int(int8_t(m_file->read8()));
+      int count = int(int8_t(in.read8()));
       if (count >= 0) {
         uint8_t* end = frame.pixels+frame.rowstride*m_height;
-        while (count-- != 0 && it < end) {
-          *it = m_file->read8();
-          ++it;
-          ++x;
+        count = int(std::max<std::ptrdiff_t>(0, std::min<std::ptrdiff_t>(count, end - it)));
+        if (skipRow)
+          in.skip(count);
+        else
+          in.read(it, count);
+        if (count > 0) {
+          changedX0 = std::min(changedX0, x);
+          changedX1 = x+count;
         }
+        it += count;
+        x += count;
         // Broken file? More bytes than available buffer
-        if (it == end)
+        if (it == end) {
+          if (m_trackChanges && !skipRow)
+            markAllChanged();
           return;
+        }
       }
       else {
-        uint8_t color = m_file->read8();
-        while (count++ != 0 && x < m_width) {
-          *it = color;
-          ++it;
-          ++x;
+        uint8_t color = in.read8();
+        count = std::max(0, std::min(-count, m_width - x));
+        if (!skipRow)
+          fill_bytes(it, color, count);
+        if (count > 0) {
+          changedX0 = std::min(changedX0, x);
+          changedX1 = x+count;
         }
+        it += count;
+        x += count;
       }
     }
+
+    if (m_trackChanges && !skipRow) {
+      // Literal pixels beyond the end of the line are copied in the
+      // next lines
+      if (changedX1 > m_width)
+        markAllChanged();
+      else
+        markChanged(y, changedX0, changedX1);
+    }
   }
 }
 
-void Decoder::readDeltaChunk(Frame& frame)
+void Decoder::readDeltaChunk(Frame& frame, ChunkReader& in)
 {
-  int nlines = read16();
+  int nlines = in.read16();
   int y = 0;
   while (nlines-- != 0) {
     int npackets = 0;
 
-    while (m_file->ok()) {
-      int16_t word = read16();
+    while (in.ok()) {
+      int16_t word = in.read16();
       if (word < 0) {          // Has bit 15 (0x8000)
         if (word & 0x4000) {   // Has bit 14 (0x4000)
           y += -word;          // Skip lines
@@ -258,9 +939,12 @@ void Decoder::readDeltaChunk(Frame& frame)
         // This code exists for animations with an odd column count. The changes at the other positions follow.
         else {
           assert(y >= 0 && y < m_height);
-          if (y >= 0 && y < m_height) {
+          if (y >= m_roiY0 && y < m_roiY1) {
             uint8_t* it = frame.pixels + y*frame.rowstride + m_width - 1;
             *it = (word & 0xff);
+
+            if (m_trackChanges)
+              markChanged(y, m_width-1, m_width);
           }
         }
       }
@@ -271,62 +955,68 @@ void Decoder::readDeltaChunk(Frame& frame)
     }
 
     // Avoid invalid data to skip more lines than the availables.
-    if (y >= m_height)
+    // Lines after the region of interest aren't needed.
+    if (y >= m_height || y >= m_roiY1)
       break;
+    const bool skipRow = (y < m_roiY0);
 
     int x = 0;
+    int changedX0 = m_width;    // Changed pixels in this line
+    int changedX1 = 0;
+    FLIC_STATS_ADD(m_stats.chunks[FLI_DELTA_CHUNK].packets, npackets);
     while (npackets-- != 0) {
-      x += m_file->read8();           // Skip pixels
-      int8_t count = m_file->read8(); // Number of words
+      x += in.read8();           // Skip pixels
+      int8_t count = in.read8(); // Number of words
 
       assert(y >= 0 && y < m_height && x >= 0 && x < m_width);
       uint8_t* it = frame.pixels + y*frame.rowstride + x;
 
       if (count >= 0) {
-        while (count-- != 0 && x < m_width) {
-          int color1 = m_file->read8();
-          int color2 = m_file->read8();
-
-          *it = color1;
-          ++it;
-          ++x;
-
-          if (x < m_width) {
-            *it = color2;
-            ++it;
-            ++x;
-          }
+        // Each word contains two pixels, but the second pixel of the
+        // last word is discarded if it is outside the frame.
+        int words = std::max(0, std::min<int>(count, (m_width - x + 1) / 2));
+        int n = std::min(2*words, m_width - x);
+        if (n > 0) {
+          if (skipRow)
+            in.skip(n);
+          else
+            in.read(it, n);
+          changedX0 = std::min(changedX0, x);
+          changedX1 = x+n;
+          it += n;
+          x += n;
         }
+        if (2*words > n)
+          in.read8();
       }
       else {
-        int color1 = m_file->read8();
-        int color2 = m_file->read8();
-
-        while (count++ != 0 && x < m_width) {
-          *it = color1;
-          ++it;
-          ++x;
-
-          if (x < m_width) {
-            *it = color2;
-            ++it;
-            ++x;
-          }
+        uint8_t color1 = in.read8();
+        uint8_t color2 = in.read8();
+        int n = std::max(0, std::min(-2*count, m_width - x));
+        if (!skipRow)
+          fill_words(it, color1, color2, n);
+        if (n > 0) {
+          changedX0 = std::min(changedX0, x);
+          changedX1 = x+n;
         }
+        it += n;
+        x += n;
       }
     }
 
+    if (m_trackChanges && !skipRow)
+      markChanged(y, changedX0, changedX1);
     ++y;
   }
 }
 
 uint16_t Decoder::read16()
 {
-  int b1 = m_file->read8();
-  int b2 = m_file->read8();
+  uint8_t b[2];
+  m_file->read(b, 2);
 
   if (m_file->ok()) {
-    return ((b2 << 8) | b1); // Little endian
+    return ((b[1] << 8) | b[0]); // Little endian
   }
   else
     return 0;
@@ -334,14 +1024,12 @@ uint16_t Decoder::read16()
 
 uint32_t Decoder::read32()
 {
-  int b1 = m_file->read8();
-  int b2 = m_file->read8();
-  int b3 = m_file->read8();
-  int b4 = m_file->read8();
+  uint8_t b[4];
+  m_file->read(b, 4);
 
   if (m_file->ok()) {
     // Little endian
-    return ((b4 << 24) | (b3 << 16) | (b2 << 8) | b1);
+    return ((uint32_t(b[3]) << 24) | (b[2] << 16) | (b[1] << 8) | b[0]);
   }
   else
     return 0;
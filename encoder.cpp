@@ -1,4 +1,5 @@
 // Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
 // Copyright (c) 2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -6,491 +7,993 @@
 
 #include "flic.h"
 #include "flic_details.h"
+#include "flic_kernels.h"
+#include "flic_stats.h"
+#include "flic_threads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
 
 namespace flic {
 
-template<typename Iterator>
-static int count_consecutive_values(Iterator begin, Iterator end)
+static bool is_line_changed(const Frame& frame,
+                            const uint8_t* prevPixels,
+                            const int width, const int y)
 {
-  Iterator prev = nullptr;
-  int same = 0;
-  for (Iterator it=begin; it!=end; prev=it, ++it) {
-    if (!prev || *prev == *it)
-      ++same;
-    else
-      break;
-  }
-  return same;
+  return !equal_bytes(frame.pixels + y*frame.rowstride,
+                      prevPixels + y*frame.rowstride, width);
 }
 
-template<typename Iterator>
-static int count_max_consecutive_values(Iterator begin, Iterator end, Iterator* maxStart)
+// Calculates the range of lines that are different from the previous
+// frame (nlines=0 if the frame is equal to the previous one)
+static void find_changed_lines(const Frame& frame,
+                               const uint8_t* prevPixels,
+                               const int width, const int height,
+                               int& skipLines, int& nlines)
 {
-  Iterator prev = nullptr;
-  Iterator curStart = nullptr;
-  *maxStart = nullptr;
-  int max = 0;
-  int same = 0;
-  for (Iterator it=begin; it!=end; prev=it, ++it) {
-    if (!prev || *prev == *it) {
-      if (!curStart)
-        curStart = it;
-
-      ++same;
-      if (max < same) {
-        max = same;
-        *maxStart = curStart;
-      }
-    }
-    else {
-      same = 0;
-      curStart = nullptr;
-    }
+  skipLines = 0;
+  while (skipLines < height &&
+         !is_line_changed(frame, prevPixels, width, skipLines))
+    ++skipLines;
+
+  int skipEndLines = 0;
+  while (height-1-skipEndLines > skipLines &&
+         !is_line_changed(frame, prevPixels, width, height-1-skipEndLines))
+    ++skipEndLines;
+
+  nlines = (height - skipEndLines - skipLines);
+}
+
+static bool is_black_frame(const Frame& frame,
+                           const int width, const int height)
+{
+  for (int y=0; y<height; ++y) {
+    const uint8_t* it = frame.pixels + y*frame.rowstride;
+    if (it[0] != 0 || equal_run(it, width) != size_t(width))
+      return false;
   }
-  return max;
+  return true;
 }
 
-template<typename Iterator1, typename Iterator2>
-static int count_max_consecutive_equal_values(Iterator1 begin1, Iterator1 end1,
-                                              Iterator2 begin2, Iterator2 end2,
-                                              Iterator2* maxStart)
+// Returns true if the next "n" pixels (before "end") are equal
+static inline bool starts_run(const uint8_t* it, const uint8_t* end, int n)
 {
-  Iterator1 it1 = begin1;
-  Iterator2 it2 = begin2;
-  Iterator2 curStart = nullptr;
-  *maxStart = nullptr;
-  int max = 0;
-  int same = 0;
-  for (; it1!=end1 && it2!=end2; ++it1, ++it2) {
-    if (*it1 == *it2) {
-      if (!curStart)
-        curStart = it2;
-
-      ++same;
-      if (max < same) {
-        max = same;
-        *maxStart = curStart;
-      }
-    }
-    else {
-      same = 0;
-      curStart = nullptr;
-    }
+  if (end - it < n)
+    return false;
+  for (int i=1; i<n; ++i)
+    if (it[i] != it[0])
+      return false;
+  return true;
+}
+
+// Returns the number of consecutive words (pairs of pixels) equal to
+// the first one (up to "max" words)
+static inline int count_same_words(const uint8_t* it, const uint8_t* end, int max)
+{
+  int words = 1;
+  for (const uint8_t* w=it+2; words<max && w<end; w+=2, ++words) {
+    if (w[0] != it[0] || (w+1 < end && w[1] != it[1]))
+      break;
   }
-  return max;
+  return words;
 }
 
-Encoder::Encoder(FileInterface* file)
+// Returns true if the next "n" pixels (before "end") are equal to
+// the previous frame
+static inline bool starts_unchanged(const uint8_t* prevIt,
+                                    const uint8_t* it, const uint8_t* end, int n)
+{
+  if (end - it < n)
+    return false;
+  for (int i=0; i<n; ++i)
+    if (prevIt[i] != it[i])
+      return false;
+  return true;
+}
+
+// Writes values in a buffer
+class Encoder::BufferWriter {
+public:
+  BufferWriter(std::vector<uint8_t>& buffer)
+    : m_buffer(buffer) {
+  }
+
+  void write8(uint8_t value) {
+    m_buffer.push_back(value);
+  }
+
+  void write16(uint16_t value) {
+    m_buffer.resize(m_buffer.size()+2);
+    put16(m_buffer.size()-2, value);
+  }
+
+  void write32(uint32_t value) {
+    m_buffer.resize(m_buffer.size()+4);
+    put32(m_buffer.size()-4, value);
+  }
+
+  void write(const uint8_t* buf, size_t n) {
+    m_buffer.insert(m_buffer.end(), buf, buf+n);
+  }
+
+  void put16(size_t pos, uint16_t value) {
+    // Little endian
+    m_buffer[pos  ] = (value & 0x00FF);
+    m_buffer[pos+1] = (value & 0xFF00) >> 8;
+  }
+
+  void put32(size_t pos, uint32_t value) {
+    // Little endian
+    m_buffer[pos  ] = (value & 0x000000FF);
+    m_buffer[pos+1] = (value & 0x0000FF00) >> 8;
+    m_buffer[pos+2] = (value & 0x00FF0000) >> 16;
+    m_buffer[pos+3] = (value & 0xFF000000) >> 24;
+  }
+
+protected:
+  std::vector<uint8_t>& m_buffer;
+};
+
+// Encodes one frame (frame header and chunks) comparing it with the
+// previous one (prevPixels/prevColormap are nullptr for the first
+// frame). Several frames can be encoded at the same time in
+// different threads, or the lines of one frame can be encoded in
+// parallel using the given threadPool/bandBuffers.
+class Encoder::FrameEncoder : public BufferWriter {
+public:
+  FrameEncoder(std::vector<uint8_t>& buffer,
+               int width, int height,
+               const uint8_t* prevPixels,
+               const Colormap* prevColormap,
+               ThreadPool* threadPool = nullptr,
+               std::vector<std::vector<uint8_t>>* bandBuffers = nullptr)
+    : BufferWriter(buffer)
+    , m_width(width)
+    , m_height(height)
+    , m_prevPixels(prevPixels)
+    , m_prevColormap(prevColormap)
+    , m_threadPool(threadPool)
+    , m_bandBuffers(bandBuffers) {
+  }
+
+  // Appends the frame to the buffer, and returns the range of lines
+  // that changed from the previous frame
+  void writeFrame(const Frame& frame, int& skipLines, int& nlines);
+
+#if FLIC_STATS
+  const Stats& stats() const { return m_stats; }
+#endif
+
+private:
+  void writeColorChunk(const Frame& frame);
+  void writeImageChunk(const Frame& frame, int skipLines, int nlines);
+  size_t estimateChunkSize(const Frame& frame, int chunkType,
+                           int skipLines, int nlines);
+  bool writeChunk(const Frame& frame, int chunkType,
+                  int skipLines, int nlines);
+  void writeCopyChunk(const Frame& frame);
+  void writeBrunChunk(const Frame& frame);
+  void writeBrunLineChunk(const Frame& frame, int y);
+  void writeLcChunk(const Frame& frame, int skipLines, int nlines);
+  void writeLcLineChunk(const Frame& frame, int y);
+  void writeDeltaChunk(const Frame& frame, int skipLines, int nlines);
+  void writeDeltaLineChunk(const Frame& frame, int y);
+  void writeLines(const Frame& frame, int skipLines, int nlines,
+                  void (FrameEncoder::*writeLine)(const Frame&, int));
+
+  int m_width, m_height;
+  const uint8_t* m_prevPixels;
+  const Colormap* m_prevColormap;
+  ThreadPool* m_threadPool;
+  std::vector<std::vector<uint8_t>>* m_bandBuffers;
+  bool m_lcOverflow = false;    // Some LC line needs more than 255 packets
+#if FLIC_STATS
+  Stats m_stats;
+  uint64_t m_packets = 0;       // Packets written by line functions
+  uint64_t m_chunkPackets = 0;  // Packets of the last writeChunk()
+#endif
+};
+
+Encoder::Encoder(FileInterface* file, BufferPool* pool)
   : m_file(file)
+  , m_pool(pool)
+  , m_fileSize(0)
   , m_frameCount(0)
   , m_offsetFrame1(0)
   , m_offsetFrame2(0)
+  , m_threads(0)
+  , m_parallelLines(false)
 {
+#if FLIC_STATS
+  m_statsFile.reset(new StatsFileInterface(file, m_stats));
+  m_file = m_statsFile.get();
+#endif
 }
 
 Encoder::~Encoder()
 {
-  // Fill header information
-  if (m_file->ok()) {
-    uint32_t size = m_file->tell();
-    m_file->seek(0);
+  // Nothing was written yet (no frames), write the header now
+  if (m_fileSize == 0) {
+    m_file->write(m_buffer.data(), m_buffer.size());
+    m_fileSize = m_buffer.size();
+  }
 
-    write32(size);              // Write file size
-    write16(FLC_MAGIC_NUMBER);  // Always as FLC file
-    write16(m_frameCount);      // Number of frames
+  // Fill header information (in streaming mode the header was
+  // already completed with the information from writeHeader())
+  if (m_file->ok() && m_file->seekable()) {
+    BufferWriter out(m_buffer);
+    m_buffer.clear();
+    out.write32(m_fileSize);        // Write file size
+    out.write16(FLC_MAGIC_NUMBER);  // Always as FLC file
+    out.write16(m_frameCount);      // Number of frames
+    m_file->seek(0);
+    m_file->write(m_buffer.data(), m_buffer.size());
 
+    m_buffer.clear();
+    out.write32(m_offsetFrame1);
+    out.write32(m_offsetFrame2);
     m_file->seek(80);
-    write32(m_offsetFrame1);
-    write32(m_offsetFrame2);
+    m_file->write(m_buffer.data(), m_buffer.size());
+  }
+
+  if (m_pool) {
+    m_pool->release(m_buffer);
+    m_pool->release(m_prevFrameData);
+    for (auto& buffer : m_frameBuffers)
+      m_pool->release(buffer);
+    for (auto& buffer : m_bandBuffers)
+      m_pool->release(buffer);
   }
 }
 
 void Encoder::writeHeader(const Header& header)
 {
-  write32(0);                // File size, to be completed in ~Encoder()
-  write16(0);                // File type
-  write16(0);                // Number of frames
-  write16(m_width = header.width);
-  write16(m_height = header.height);
-  write16(8);
-  write16(0);                // Flags
-  write32(header.speed);
-  m_file->seek(128);
+  if (m_pool) {
+    if (m_buffer.capacity() == 0)
+      m_buffer = m_pool->take(128);
+    if (m_prevFrameData.capacity() == 0)
+      m_prevFrameData = m_pool->take(size_t(header.width)*header.height);
+  }
+
+  // The header is kept in m_buffer and written with the first frame
+  BufferWriter out(m_buffer);
+  m_buffer.clear();
+  out.write32(0);                // File size, to be completed in ~Encoder()
+  out.write16(FLC_MAGIC_NUMBER); // Always as FLC file
+  out.write16(header.frames);    // Number of frames, replaced in ~Encoder()
+  out.write16(m_width = header.width);
+  out.write16(m_height = header.height);
+  out.write16(8);
+  out.write16(0);                // Flags
+  out.write32(header.speed);
+  m_buffer.resize(128);          // Padding (and offsets of frames 1 and 2)
 }
 
 void Encoder::writeFrame(const Frame& frame)
 {
-  uint32_t frameStartPos = m_file->tell();
-  int nchunks = 0;
+  writeFrames(&frame, 1);
+}
+
+void Encoder::writeFrames(const Frame* frames, int nframes)
+{
+  if (nframes <= 0)
+    return;
 
-  switch (m_frameCount) {
-    case 0: m_offsetFrame1 = frameStartPos; break;
-    case 1: m_offsetFrame2 = frameStartPos; break;
+  while (int(m_frameBuffers.size()) < nframes) {
+    m_frameBuffers.push_back(m_pool ? m_pool->take(size_t(m_width)*m_height):
+                                      std::vector<uint8_t>());
   }
 
+  // Each frame depends only on the pixels of the previous one, so
+  // all frames can be encoded at the same time in different buffers
+  int skipLines = 0, nlines = 0; // Changed lines of the last frame
+#if FLIC_STATS
+  std::mutex statsMutex;
+#endif
+  auto encodeFrame = [&](int i){
+    const uint8_t* prevPixels = nullptr;
+    const Colormap* prevColormap = nullptr;
+    if (i > 0) {
+      prevPixels = frames[i-1].pixels;
+      prevColormap = &frames[i-1].colormap;
+    }
+    else if (m_frameCount > 0) {
+      prevPixels = m_prevFrameData.data();
+      prevColormap = &m_prevColormap;
+    }
+
+    // When frames are encoded in parallel, their lines cannot be
+    // encoded in parallel too (nested ThreadPool::parallelFor())
+    ThreadPool* linesThreadPool = nullptr;
+    if (m_parallelLines && nframes == 1) {
+      if (!m_threadPool)
+        m_threadPool.reset(new ThreadPool(m_threads));
+      linesThreadPool = m_threadPool.get();
+    }
+
+    int skip, n;
+    m_frameBuffers[i].clear();
+    FrameEncoder encoder(m_frameBuffers[i], m_width, m_height,
+                         prevPixels, prevColormap,
+                         linesThreadPool, &m_bandBuffers);
+    encoder.writeFrame(frames[i], skip, n);
+
+#if FLIC_STATS
+    {
+      std::lock_guard<std::mutex> lock(statsMutex);
+      add_stats(m_stats, encoder.stats());
+    }
+#endif
+
+    if (i == nframes-1) {
+      skipLines = skip;
+      nlines = n;
+    }
+  };
+
+  if (nframes > 1) {
+    if (!m_threadPool)
+      m_threadPool.reset(new ThreadPool(m_threads));
+    m_threadPool->parallelFor(nframes, encodeFrame);
+  }
+  else
+    encodeFrame(0);
+
+  // Update the previous frame data (only the changed lines if the
+  // previous frame data was the one used to encode this frame)
+  const Frame& lastFrame = frames[nframes-1];
+  const size_t size = m_height*lastFrame.rowstride;
+  if (nframes > 1 || m_prevFrameData.size() != size) {
+    m_prevFrameData.resize(size);
+    skipLines = 0;
+    nlines = m_height;
+  }
+  std::copy(lastFrame.pixels+(skipLines*lastFrame.rowstride),
+            lastFrame.pixels+((skipLines+nlines)*lastFrame.rowstride),
+            m_prevFrameData.begin()+(skipLines*lastFrame.rowstride));
+  m_prevColormap = lastFrame.colormap;
+
+  for (int i=0; i<nframes; ++i)
+    writeFrameData(m_frameBuffers[i]);
+}
+
+void Encoder::writeRingFrame(const Frame& frame)
+{
+  writeFrame(frame);
+  --m_frameCount;
+}
+
+void Encoder::setThreads(int threads)
+{
+  m_threads = threads;
+  m_threadPool.reset();
+}
+
+void Encoder::setParallelLines(bool state)
+{
+  m_parallelLines = state;
+}
+
+void Encoder::writeFrameData(const std::vector<uint8_t>& data)
+{
+  // The header is written with the first frame, so we can complete
+  // the offsets of the first and second frames before writing it
+  // (required when the file is not seekable).
+  if (m_fileSize == 0) {
+    m_offsetFrame1 = m_buffer.size();
+    m_offsetFrame2 = m_offsetFrame1 + data.size();
+
+    BufferWriter out(m_buffer);
+    out.put32(80, m_offsetFrame1);
+    out.put32(84, m_offsetFrame2);
+    m_file->write(m_buffer.data(), m_buffer.size());
+    m_fileSize = m_buffer.size();
+  }
+
+  m_file->write(data.data(), data.size());
+  m_fileSize += data.size();
+  ++m_frameCount;
+}
+
+void Encoder::FrameEncoder::writeFrame(const Frame& frame,
+                                       int& skipLines, int& nlines)
+{
+  int nchunks = 0;
+  size_t frameStartPos = m_buffer.size();
+
   write32(0);           // Frame size will be written at the end of this function
   write16(0);           // Magic number
   write16(0);           // Number of chunks
   write32(0);           // Padding
   write32(0);
 
-  if (m_frameCount == 0 || m_prevColormap != frame.colormap) {
+  if (!m_prevColormap || *m_prevColormap != frame.colormap) {
     writeColorChunk(frame);
     ++nchunks;
   }
 
-  if (m_frameCount == 0) {
-    writeBrunChunk(frame);
+  if (!m_prevPixels) {
+    skipLines = 0;
+    nlines = m_height;
+    writeImageChunk(frame, skipLines, nlines);
     ++nchunks;
-
-    // Create the buffer to store previous frame pixels
-    m_prevFrameData.resize(m_height*frame.rowstride);
-    std::copy(frame.pixels,
-              frame.pixels+m_height*frame.rowstride,
-              m_prevFrameData.begin());
   }
   else {
-    writeLcChunk(frame);
-    ++nchunks;
+    find_changed_lines(frame, m_prevPixels, m_width, m_height,
+                       skipLines, nlines);
+
+    // Frames equal to the previous one don't need a chunk
+    if (nlines > 0) {
+      writeImageChunk(frame, skipLines, nlines);
+      ++nchunks;
+    }
   }
 
-  size_t frameEndPos = m_file->tell();
-  m_file->seek(frameStartPos);
-  write32(frameEndPos - frameStartPos); // Frame size
-  write16(FLI_FRAME_MAGIC_NUMBER);      // Chunk type
-  write16(nchunks);                     // Number of chunks
+  put32(frameStartPos, m_buffer.size() - frameStartPos); // Frame size
+  put16(frameStartPos+4, FLI_FRAME_MAGIC_NUMBER);        // Chunk type
+  put16(frameStartPos+6, nchunks);                       // Number of chunks
 
-  m_file->seek(frameEndPos);
-  ++m_frameCount;
+  FLIC_STATS_ADD(m_stats.frames, 1);
+  FLIC_STATS_ADD(m_stats.frameBytes, m_buffer.size() - frameStartPos);
 }
 
-void Encoder::writeRingFrame(const Frame& frame)
+void Encoder::FrameEncoder::writeColorChunk(const Frame& frame)
 {
-  writeFrame(frame);
-  --m_frameCount;
-}
+#if FLIC_STATS
+  const StatsTime t0 = stats_now();
+#endif
 
-void Encoder::writeColorChunk(const Frame& frame)
-{
   // Chunk header
-  size_t chunkBeginPos = m_file->tell();
+  size_t chunkBeginPos = m_buffer.size();
   write32(0);           // Chunk size (this will be re-written below)
   write16(0);           // Chunk type
   write16(0);           // Write number of packets in this chunk
 
-  // Write packets
+  // Write one packet for each range of changed colors (it's never
+  // worth to include unchanged colors: 3 bytes per color vs the 2
+  // bytes of a new packet header)
   int npackets = 0;
   int skip = 0;
   for (int i=0; i<256; ) {
-    if (m_frameCount == 0 ||
-        m_prevColormap[i] != frame.colormap[i]) {
-      int ncolors;
-      if (m_frameCount == 0) {
-        ncolors = 256;
-      }
-      else {
-        ncolors = 1;
-        for (int j=i+1; j<256; ++j) {
-          if (m_prevColormap[j] != frame.colormap[j])
-            ++ncolors;
-        }
-      }
+    if (m_prevColormap && (*m_prevColormap)[i] == frame.colormap[i]) {
+      ++skip;
+      ++i;
+      continue;
+    }
 
-      assert(ncolors > 0);
+    int ncolors = 1;
+    if (!m_prevColormap)
+      ncolors = 256;
+    else {
+      while (i+ncolors < 256 &&
+             (*m_prevColormap)[i+ncolors] != frame.colormap[i+ncolors])
+        ++ncolors;
+    }
 
-      ++npackets;
-      m_file->write8(skip); // How many colors to skip from previous packet
-      m_file->write8(ncolors == 256 ? 0: ncolors); // 0 means 256 colors
-
-      // Write colors
-      for (int j=i; j<ncolors; ++j) {
-        const Color a = frame.colormap[j];
-        m_file->write8(a.r);
-        m_file->write8(a.g);
-        m_file->write8(a.b);
-      }
+    ++npackets;
+    write8(skip); // How many colors to skip from previous packet
+    write8(ncolors == 256 ? 0: ncolors); // 0 means 256 colors
 
-      i += ncolors;
-      skip = 0;
-    }
-    else {
-      ++skip;
-      ++i;
+    // Write colors
+    for (int j=i; j<i+ncolors; ++j) {
+      const Color a = frame.colormap[j];
+      write8(a.r);
+      write8(a.g);
+      write8(a.b);
     }
+
+    i += ncolors;
+    skip = 0;
   }
 
   assert(npackets > 0);
 
   // Update chunk size
-  size_t chunkEndPos = m_file->tell();
-  m_file->seek(chunkBeginPos);
+  if ((m_buffer.size() - chunkBeginPos) & 1) // Avoid odd chunk size
+    write8(0);
 
-  if ((chunkEndPos - chunkBeginPos) & 1) // Avoid odd chunk size
-    ++chunkEndPos;
+  put32(chunkBeginPos, m_buffer.size() - chunkBeginPos); // Chunk size
+  put16(chunkBeginPos+4, FLI_COLOR_256_CHUNK);           // Chunk type
+  put16(chunkBeginPos+6, npackets);                      // Number of packets
 
-  write32(chunkEndPos - chunkBeginPos); // Chunk size
-  write16(FLI_COLOR_256_CHUNK);         // Chunk type
-  write16(npackets);                    // Number of packets
-  m_file->seek(chunkEndPos);
+#if FLIC_STATS
+  add_chunk_stats(m_stats, FLI_COLOR_256_CHUNK, m_buffer.size() - chunkBeginPos,
+                  npackets, stats_seconds_since(t0));
+#endif
+}
+
+void Encoder::FrameEncoder::writeImageChunk(const Frame& frame, int skipLines, int nlines)
+{
+  // A black frame is the cheapest one (a chunk without data)
+  if (is_black_frame(frame, m_width, m_height)) {
+    writeChunk(frame, FLI_BLACK_CHUNK, skipLines, nlines);
+#if FLIC_STATS
+    add_chunk_stats(m_stats, FLI_BLACK_CHUNK, 6, 0, 0.0);
+#endif
+    return;
+  }
+
+  // Candidates to encode the frame pixels with their estimated size
+  struct Candidate {
+    int type;
+    size_t size;
+  } candidates[4];
+  int ncandidates = 0;
+
+  candidates[ncandidates++] = { FLI_BRUN_CHUNK, estimateChunkSize(frame, FLI_BRUN_CHUNK, 0, m_height) };
+
+  // Delta chunks can be used only if we have a previous frame
+  if (m_prevPixels) {
+    candidates[ncandidates++] = { FLI_LC_CHUNK, estimateChunkSize(frame, FLI_LC_CHUNK, skipLines, nlines) };
+    candidates[ncandidates++] = { FLI_DELTA_CHUNK, estimateChunkSize(frame, FLI_DELTA_CHUNK, skipLines, nlines) };
+  }
+
+  // The decoder supports COPY chunks only for 320x200 animations
+  if (m_width == 320 && m_height == 200)
+    candidates[ncandidates++] = { FLI_COPY_CHUNK, 6 + 320*200 };
+
+  std::sort(candidates, candidates+ncandidates,
+            [](const Candidate& a, const Candidate& b){
+              return a.size < b.size;
+            });
+
+  // Encode the best candidate, and if the estimated size of the
+  // second one is too close, encode it too and keep the smallest.
+  // A candidate that cannot encode the frame (LC with too many
+  // packets in a line) is discarded, BRUN can encode any frame.
+  size_t firstPos = m_buffer.size();
+  int first = 0;
+  while (!writeChunk(frame, candidates[first].type, skipLines, nlines)) {
+    m_buffer.resize(firstPos);
+    ++first;
+    assert(first < ncandidates);
+  }
+#if FLIC_STATS
+  int keptType = candidates[first].type;
+  uint64_t keptPackets = m_chunkPackets;
+#endif
+
+  const int second = first+1;
+  if (second < ncandidates &&
+      candidates[second].size - candidates[first].size <= candidates[first].size / 8) {
+    size_t secondPos = m_buffer.size();
+    if (writeChunk(frame, candidates[second].type, skipLines, nlines) &&
+        m_buffer.size() - secondPos < secondPos - firstPos) {
+      m_buffer.erase(m_buffer.begin()+firstPos, m_buffer.begin()+secondPos);
+#if FLIC_STATS
+      keptType = candidates[second].type;
+      keptPackets = m_chunkPackets;
+#endif
+    }
+    else
+      m_buffer.resize(secondPos);
+  }
+
+#if FLIC_STATS
+  // The time of all encoded chunks was added in writeChunk(), here
+  // we count only the chunk that was kept
+  add_chunk_stats(m_stats, keptType, m_buffer.size() - firstPos,
+                  keptPackets, 0.0);
+#endif
+}
+
+size_t Encoder::FrameEncoder::estimateChunkSize(const Frame& frame, int chunkType,
+                                                int skipLines, int nlines)
+{
+  // We encode a sample of lines (up to ~32 lines) to estimate the
+  // size of the whole chunk
+  const int step = std::max(1, nlines / 32);
+  size_t pos = m_buffer.size();
+  int sampledLines = 0;
+  m_lcOverflow = false;
+  for (int y=skipLines; y<skipLines+nlines; y+=step, ++sampledLines) {
+    switch (chunkType) {
+      case FLI_BRUN_CHUNK:
+        writeBrunLineChunk(frame, y);
+        break;
+      case FLI_LC_CHUNK:
+        writeLcLineChunk(frame, y);
+        break;
+      case FLI_DELTA_CHUNK:
+        if (is_line_changed(frame, m_prevPixels, m_width, y))
+          writeDeltaLineChunk(frame, y);
+        break;
+    }
+  }
+
+  size_t size = m_buffer.size() - pos;
+  m_buffer.resize(pos);
+
+  // LC cannot encode this frame
+  if (chunkType == FLI_LC_CHUNK && m_lcOverflow)
+    return std::numeric_limits<size_t>::max();
+
+  if (sampledLines > 0)
+    size = size * nlines / sampledLines;
+  return 10 + size;             // Chunk header + lines
+}
+
+// Returns false if the frame cannot be encoded with the given chunk
+// type (the buffer will contain an invalid chunk that must be removed)
+bool Encoder::FrameEncoder::writeChunk(const Frame& frame, int chunkType,
+                                       int skipLines, int nlines)
+{
+  m_lcOverflow = false;
+
+#if FLIC_STATS
+  const StatsTime t0 = stats_now();
+  const uint64_t packets0 = m_packets;
+#endif
+
+  switch (chunkType) {
+    case FLI_BLACK_CHUNK:
+      write32(6);               // Chunk size
+      write16(FLI_BLACK_CHUNK);
+      break;
+    case FLI_BRUN_CHUNK:  writeBrunChunk(frame); break;
+    case FLI_COPY_CHUNK:  writeCopyChunk(frame); break;
+    case FLI_LC_CHUNK:    writeLcChunk(frame, skipLines, nlines); break;
+    case FLI_DELTA_CHUNK: writeDeltaChunk(frame, skipLines, nlines); break;
+  }
 
-  m_prevColormap = frame.colormap;
+#if FLIC_STATS
+  m_stats.chunks[chunkType].seconds += stats_seconds_since(t0);
+  m_chunkPackets = m_packets - packets0;
+#endif
+  return !(chunkType == FLI_LC_CHUNK && m_lcOverflow);
 }
 
-void Encoder::writeBrunChunk(const Frame& frame)
+void Encoder::FrameEncoder::writeCopyChunk(const Frame& frame)
+{
+  write32(6 + m_width*m_height); // Chunk size
+  write16(FLI_COPY_CHUNK);
+  for (int y=0; y<m_height; ++y)
+    write(frame.pixels + y*frame.rowstride, m_width);
+}
+
+void Encoder::FrameEncoder::writeBrunChunk(const Frame& frame)
 {
   // Chunk header
-  size_t chunkBeginPos = m_file->tell();
+  size_t chunkBeginPos = m_buffer.size();
   write32(0);           // Chunk size (this will be re-written below)
   write16(FLI_BRUN_CHUNK);
 
-  for (int y=0; y<m_height; ++y)
-    writeBrunLineChunk(frame, y);
+  writeLines(frame, 0, m_height, &FrameEncoder::writeBrunLineChunk);
 
   // Update chunk size
-  size_t chunkEndPos = m_file->tell();
-  m_file->seek(chunkBeginPos);
-
-  if ((chunkEndPos - chunkBeginPos) & 1) // Avoid odd chunk size
-    ++chunkEndPos;
+  if ((m_buffer.size() - chunkBeginPos) & 1) // Avoid odd chunk size
+    write8(0);
 
-  write32(chunkEndPos - chunkBeginPos);
-  m_file->seek(chunkEndPos);
+  put32(chunkBeginPos, m_buffer.size() - chunkBeginPos);
 }
 
-void Encoder::writeBrunLineChunk(const Frame& frame, int y)
+void Encoder::FrameEncoder::writeBrunLineChunk(const Frame& frame, int y)
 {
-  size_t npacketsPos = m_file->tell();
-  m_file->write8(0); // Number of packets, it will be re-written later
+  size_t npacketsPos = m_buffer.size();
+  write8(0); // Number of packets, it will be re-written later
 
   // Number of packets
   int npackets = 0;
 
-  uint8_t* it = frame.pixels + y*frame.rowstride;
-  for (int x=0; x<m_width; ) {
-    int remain = (m_width-x);
-    uint8_t* maxSameStart = nullptr;
-
-    int samePixels = count_consecutive_values(it, it+remain);
-    int maxSamePixels = count_max_consecutive_values(it, it+remain, &maxSameStart);
+  const uint8_t* it = frame.pixels + y*frame.rowstride;
+  const uint8_t* lineEnd = it + m_width;
 
+  for (int x=0; x<m_width; ) {
     // We can compress 127 equal pixels in one packet
-    if (samePixels > 127)
-      samePixels = 127;
+    int samePixels = equal_run(it+x, std::min(m_width-x, 127));
 
     if (samePixels >= 4) {
       // One packet to compress "samePixels"
       ++npackets;
-      m_file->write8(samePixels);
-      m_file->write8(*it);
+      write8(samePixels);
+      write8(it[x]);
 
-      it += samePixels;
       x += samePixels;
     }
     else {
-      // We can include 128 pixels in one packet
-      if (remain > 128)
-        remain = 128;
-
-      // Is it better to reduce this packet just to compress future same pixels?
-      if (maxSamePixels >= 4 && remain > (maxSameStart-it))
-        remain = (maxSameStart-it);
+      // We can include 128 pixels in one packet, but we stop just
+      // before the next run of 4 or more equal pixels (it's better
+      // to compress it in its own packet)
+      int end = std::min(x+128, m_width);
+      int remain = samePixels;
+      while (x+remain < end && !starts_run(it+x+remain, lineEnd, 4))
+        ++remain;
 
       assert(remain > 0);
 
       ++npackets;
-      m_file->write8(-remain);
-      for (int i=0; i<remain; ++i, ++it)
-        m_file->write8(*it);
+      write8(-remain);
+      write(it+x, remain);
 
       x += remain;
     }
   }
 
-  size_t restorePos = m_file->tell();
-  m_file->seek(npacketsPos);
-  m_file->write8(npackets < 255 ? npackets: 255);
-  m_file->seek(restorePos);
+  // In FLC files 0 packets means that the line can contain more
+  // than 255 packets (see Decoder::readBrunChunk())
+  m_buffer[npacketsPos] = (npackets <= 255 ? npackets: 0);
+  FLIC_STATS_ADD(m_packets, npackets);
 }
 
-void Encoder::writeLcChunk(const Frame& frame)
+void Encoder::FrameEncoder::writeLcChunk(const Frame& frame, int skipLines, int nlines)
 {
-  int skipLines = 0;
-  for (int y=0; y<m_height; ++y) {
-    std::vector<uint8_t>::iterator prevIt =
-      m_prevFrameData.begin() + y*frame.rowstride;
-    uint8_t* it = frame.pixels + y*frame.rowstride;
-
-    for (int x=0; x<m_width; ++x, ++it, ++prevIt) {
-      if (*prevIt != *it)
-        goto firstScanDone;
-    }
-
-    ++skipLines;
-  }
-
-firstScanDone:;
-
-  int skipEndLines = 0;
-  for (int y=m_height-1; y > skipLines; --y) {
-    std::vector<uint8_t>::iterator prevIt =
-      m_prevFrameData.begin() + y*frame.rowstride;
-    uint8_t* it = frame.pixels + y*frame.rowstride;
-
-    for (int x=0; x<m_width; ++x, ++it, ++prevIt) {
-      if (*prevIt != *it)
-        goto secondScanDone;
-    }
-
-    ++skipEndLines;
-  }
-
-secondScanDone:;
-
-  int nlines = (m_height - skipEndLines - skipLines);
-
   // Chunk header
-  size_t chunkBeginPos = m_file->tell();
+  size_t chunkBeginPos = m_buffer.size();
   write32(0);            // Chunk size (this will be re-written below)
   write16(FLI_LC_CHUNK);
   write16(skipLines);    // How many lines to skip
   write16(nlines);
 
-  for (int y=skipLines; y<skipLines+nlines; ++y)
-    writeLcLineChunk(frame, y);
-
-  // Update the previous frame data
-  if (nlines > 0)
-    std::copy(frame.pixels+(skipLines*frame.rowstride),
-              frame.pixels+((skipLines+nlines)*frame.rowstride),
-              m_prevFrameData.begin()+(skipLines*frame.rowstride));
+  writeLines(frame, skipLines, nlines, &FrameEncoder::writeLcLineChunk);
 
   // Update chunk size
-  size_t chunkEndPos = m_file->tell();
-  m_file->seek(chunkBeginPos);
+  if ((m_buffer.size() - chunkBeginPos) & 1) // Avoid odd chunk size
+    write8(0);
 
-  if ((chunkEndPos - chunkBeginPos) & 1) // Avoid odd chunk size
-    ++chunkEndPos;
-
-  write32(chunkEndPos - chunkBeginPos);
-  m_file->seek(chunkEndPos);
+  put32(chunkBeginPos, m_buffer.size() - chunkBeginPos);
 }
 
-void Encoder::writeLcLineChunk(const Frame& frame, int y)
+void Encoder::FrameEncoder::writeLcLineChunk(const Frame& frame, int y)
 {
-  size_t npacketsPos = m_file->tell();
-  m_file->write8(0); // Number of packets, it will be re-written later
+  size_t npacketsPos = m_buffer.size();
+  write8(0); // Number of packets, it will be re-written later
+
+  // Unchanged line, zero packets
+  if (!is_line_changed(frame, m_prevPixels, m_width, y))
+    return;
+
+  const uint8_t* prevIt = m_prevPixels + y*frame.rowstride;
+  const uint8_t* it = frame.pixels + y*frame.rowstride;
+  const uint8_t* lineEnd = it + m_width;
+  int lastChanged = -1;         // Calculated only when it's needed
 
   // Number of packets
   int npackets = 0;
   int skipPixels = 0;
 
-  std::vector<uint8_t>::iterator prevIt =
-    m_prevFrameData.begin() + y*frame.rowstride;
-  uint8_t* it = frame.pixels + y*frame.rowstride;
-
   for (int x=0; x<m_width; ) {
-    if (*prevIt != *it) {
-      while (skipPixels > 255) {
-        // One empty packet to skip 255 pixels that are equal to the previous frame
-        ++npackets;
-        m_file->write8(255);
-        m_file->write8(0);
-
-        skipPixels -= 255;
-      }
+    // Skip pixels that are equal to the previous frame
+    int unchangedPixels = first_diff(prevIt+x, it+x, m_width-x);
+    if (unchangedPixels > 0) {
+      skipPixels += unchangedPixels;
+      x += unchangedPixels;
+      continue;
+    }
 
-      // New packet
+    while (skipPixels > 255) {
+      // One empty packet to skip 255 pixels that are equal to the previous frame
       ++npackets;
-      m_file->write8(skipPixels);
-
-      int remain = (m_width-x);
-      if (remain > 128)
-        remain = 128;
-
-      // Calculate if there is a strip of equal pixels with the
-      // previous frame in the following pixels
-      uint8_t* maxUnchangedStart = nullptr;
-      int maxUnchangedPixels =
-        count_max_consecutive_equal_values(prevIt, prevIt+remain,
-                                           it, it+remain,
-                                           &maxUnchangedStart);
-      if (maxUnchangedPixels > 4 && remain > (maxUnchangedStart-it))
-        remain = (maxUnchangedStart-it);
-
-      // Check if we can create a compressed packet
-      uint8_t* maxSameStart = nullptr;
-      int samePixels = count_consecutive_values(it, it+remain);
-      int maxSamePixels = count_max_consecutive_values(it, it+remain, &maxSameStart);
-
-      // We can compress 128 equal pixels in one packet
-      if (samePixels > 128)
-        samePixels = 128;
-
-      if (samePixels >= 4) {
-        // One packet to compress "samePixels"
-        m_file->write8(-samePixels);
-        m_file->write8(*it);
-
-        prevIt += samePixels;
-        it += samePixels;
-        x += samePixels;
-      }
-      else {
-        // We can include 127 pixels in one packet
-        if (remain > 127)
-          remain = 127;
+      write8(255);
+      write8(0);
 
-        // Is it better to reduce this packet just to compress future same pixels?
-        if (maxSamePixels >= 4 && remain > (maxSameStart-it))
-          remain = (maxSameStart-it);
+      skipPixels -= 255;
+    }
 
-        assert(remain > 0);
+    // New packet
+    ++npackets;
+    write8(skipPixels);
+    skipPixels = 0;
+
+    // The number of packets in a line is limited to 255, so if we
+    // are near that limit, we use literal packets to copy all pixels
+    // up to the last changed one.
+    if (npackets + (m_width-1-x)/127 >= 255) {
+      if (lastChanged < 0) {
+        lastChanged = m_width-1;
+        while (prevIt[lastChanged] == it[lastChanged])
+          --lastChanged;
+      }
+    }
+    if (lastChanged >= 0 && npackets + (lastChanged-x)/127 >= 255) {
+      for (;;) {
+        int remain = std::min(lastChanged+1-x, 127);
+        write8(remain);
+        write(it+x, remain);
+        x += remain;
 
-        m_file->write8(remain);
-        for (int i=0; i<remain; ++i, ++it)
-          m_file->write8(*it);
+        if (x > lastChanged)
+          break;
 
-        prevIt += remain;
-        x += remain;
+        ++npackets;
+        write8(0);
       }
+      break;
+    }
 
-      skipPixels = 0;
+    // We can compress 128 equal pixels in one packet
+    int samePixels = equal_run(it+x, std::min(m_width-x, 128));
+    if (samePixels >= 4) {
+      // One packet to compress "samePixels"
+      write8(-samePixels);
+      write8(it[x]);
+
+      x += samePixels;
     }
     else {
-      ++skipPixels;
-      ++prevIt;
-      ++it;
-      ++x;
+      // We can include 127 pixels in one packet, but we stop before
+      // 3 or more unchanged pixels (it's better to skip them with a
+      // new packet) or 4 or more equal pixels (it's better to
+      // compress them)
+      int end = std::min(x+127, m_width);
+      int remain = 1;
+      while (x+remain < end &&
+             !starts_unchanged(prevIt+x+remain, it+x+remain, lineEnd, 3) &&
+             !starts_run(it+x+remain, lineEnd, 4))
+        ++remain;
+
+      write8(remain);
+      write(it+x, remain);
+
+      x += remain;
     }
   }
 
-  if (skipPixels != m_width) {
-    assert(npackets != 0);
+  // Lines with a very big span of changes (more than 255*127 pixels)
+  // cannot be stored in 255 packets, so LC cannot be used for this
+  // frame
+  if (npackets > 255)
+    m_lcOverflow = true;
+  m_buffer[npacketsPos] = uint8_t(std::min(npackets, 255));
+  FLIC_STATS_ADD(m_packets, npackets);
+}
 
-    size_t restorePos = m_file->tell();
-    m_file->seek(npacketsPos);
-    m_file->write8(npackets < 255 ? npackets: 255);
-    m_file->seek(restorePos);
+// Each line packet is independent from the others, so big frames are
+// encoded in bands of lines in parallel (in separated buffers that
+// are then concatenated).
+void Encoder::FrameEncoder::writeLines(const Frame& frame,
+                                       int skipLines, int nlines,
+                                       void (FrameEncoder::*writeLine)(const Frame&, int))
+{
+  const int kMinBandPixels = 64*1024;
+  int nbands = 1;
+  if (m_threadPool && m_threadPool->threads() > 1) {
+    nbands = std::min(m_threadPool->threads()*4,
+                      int(size_t(m_width)*nlines / kMinBandPixels));
   }
-  else {
-    assert(npackets == 0);
+
+  if (nbands < 2) {
+    for (int y=skipLines; y<skipLines+nlines; ++y)
+      (this->*writeLine)(frame, y);
+    return;
   }
+
+  std::vector<std::vector<uint8_t>>& buffers = *m_bandBuffers;
+  if (int(buffers.size()) < nbands)
+    buffers.resize(nbands);
+
+  std::atomic<bool> bandOverflow(false);
+#if FLIC_STATS
+  std::atomic<uint64_t> bandPackets(0);
+#endif
+
+  m_threadPool->parallelFor(nbands, [&](int i){
+    const int y0 = skipLines + nlines*i/nbands;
+    const int y1 = skipLines + nlines*(i+1)/nbands;
+    buffers[i].clear();
+    FrameEncoder band(buffers[i], m_width, m_height,
+                      m_prevPixels, m_prevColormap);
+    for (int y=y0; y<y1; ++y)
+      (band.*writeLine)(frame, y);
+    if (band.m_lcOverflow)
+      bandOverflow = true;
+
+    FLIC_STATS_ADD(bandPackets, band.m_packets);
+  });
+  FLIC_STATS_ADD(m_packets, bandPackets);
+  if (bandOverflow)
+    m_lcOverflow = true;
+
+  for (int i=0; i<nbands; ++i)
+    write(buffers[i].data(), buffers[i].size());
 }
 
-void Encoder::write16(uint16_t value)
+void Encoder::FrameEncoder::writeDeltaChunk(const Frame& frame, int skipLines, int nlines)
 {
-  // Little endian
-  m_file->write8(value & 0x00FF);
-  m_file->write8((value & 0xFF00) >> 8);
+  // Chunk header
+  size_t chunkBeginPos = m_buffer.size();
+  write32(0);            // Chunk size (this will be re-written below)
+  write16(FLI_DELTA_CHUNK);
+  write16(0);            // Number of encoded lines (re-written below)
+
+  int encodedLines = 0;
+  int skip = skipLines;
+  for (int y=skipLines; y<skipLines+nlines; ++y) {
+    if (!is_line_changed(frame, m_prevPixels, m_width, y)) {
+      ++skip;
+      continue;
+    }
+
+    // Skip unchanged lines, each word (with bits 15 and 14 set) can
+    // skip up to 16384 lines
+    while (skip > 0) {
+      int n = std::min(skip, 16384);
+      write16(uint16_t(-n));
+      skip -= n;
+    }
+
+    writeDeltaLineChunk(frame, y);
+    ++encodedLines;
+  }
+
+  put16(chunkBeginPos+6, encodedLines);
+
+  // Update chunk size
+  if ((m_buffer.size() - chunkBeginPos) & 1) // Avoid odd chunk size
+    write8(0);
+
+  put32(chunkBeginPos, m_buffer.size() - chunkBeginPos);
 }
 
-void Encoder::write32(uint32_t value)
+void Encoder::FrameEncoder::writeDeltaLineChunk(const Frame& frame, int y)
 {
-  // Little endian
-  m_file->write8((int)value & 0x00FF);
-  m_file->write8((int)((value & 0x0000FF00L) >> 8));
-  m_file->write8((int)((value & 0x00FF0000L) >> 16));
-  m_file->write8((int)((value & 0xFF000000L) >> 24));
+  size_t npacketsPos = m_buffer.size();
+  write16(0); // Number of packets, it will be re-written later
+
+  const uint8_t* prevIt = m_prevPixels + y*frame.rowstride;
+  const uint8_t* it = frame.pixels + y*frame.rowstride;
+  const uint8_t* lineEnd = it + m_width;
+
+  // Number of packets
+  int npackets = 0;
+  int skipPixels = 0;
+
+  for (int x=0; x<m_width; ) {
+    // Skip pixels that are equal to the previous frame
+    int unchangedPixels = first_diff(prevIt+x, it+x, m_width-x);
+    if (unchangedPixels > 0) {
+      skipPixels += unchangedPixels;
+      x += unchangedPixels;
+      continue;
+    }
+
+    while (skipPixels > 255) {
+      // One empty packet to skip 255 pixels that are equal to the previous frame
+      ++npackets;
+      write8(255);
+      write8(0);
+
+      skipPixels -= 255;
+    }
+
+    // New packet
+    ++npackets;
+    write8(skipPixels);
+    skipPixels = 0;
+
+    // Packets contain words (pairs of pixels), the second pixel of a
+    // word after the end of the line is ignored by the decoder. We
+    // can compress 128 equal words in one packet.
+    int sameWords = count_same_words(it+x, lineEnd, 128);
+    if (sameWords >= 2) {
+      write8(-sameWords);
+      write8(it[x]);
+      write8(x+1 < m_width ? it[x+1]: 0);
+
+      x += 2*sameWords;
+    }
+    else {
+      // We can include 127 words in one packet, but we stop before 4
+      // or more unchanged pixels or 3 or more equal words
+      int words = 1;
+      while (words < 127 && x+2*words < m_width &&
+             !starts_unchanged(prevIt+x+2*words, it+x+2*words, lineEnd, 4) &&
+             count_same_words(it+x+2*words, lineEnd, 3) < 3)
+        ++words;
+
+      int n = std::min(2*words, m_width-x);
+      write8(words);
+      write(it+x, n);
+      if (n < 2*words)
+        write8(0);
+
+      x += 2*words;
+    }
+  }
+
+  assert(npackets > 0 && npackets < 0x4000);
+  put16(npacketsPos, npackets);
+  FLIC_STATS_ADD(m_packets, npackets);
 }
 
 } // namespace flic
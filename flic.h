@@ -1,5 +1,5 @@
 // Aseprite FLIC Library
-// Copyright (c) 2025 Igara Studio S.A.
+// Copyright (c) 2025-2026 Igara Studio S.A.
 // Copyright (c) 2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -13,6 +13,8 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <vector>
 
 namespace flic {
@@ -35,6 +37,9 @@ namespace flic {
     }
   };
 
+  // Colormap comparisons use memcmp(), so there must be no padding
+  static_assert(sizeof(Color) == 3, "Color must be 3 bytes");
+
   struct Header {
     int frames;
     int width;
@@ -64,11 +69,7 @@ namespace flic {
     }
 
     bool operator==(const Colormap& o) const {
-      for (int i=0; i<SIZE; ++i) {
-        if (m_color[i] != o[i])
-          return false;
-      }
-      return true;
+      return (std::memcmp(m_color, o.m_color, sizeof(m_color)) == 0);
     }
 
     bool operator!=(const Colormap& o) const {
@@ -85,6 +86,78 @@ namespace flic {
     Colormap colormap;
   };
 
+  enum class PixelFormat {
+    RGBA8,                      // 4 bytes per pixel (R, G, B, A=255)
+    BGRA8,                      // 4 bytes per pixel (B, G, R, A=255)
+    RGB565,                     // uint16_t per pixel
+  };
+
+  struct Rect {
+    int x, y, w, h;
+
+    Rect() : x(0), y(0), w(0), h(0) {
+    }
+
+    Rect(int x, int y, int w, int h) : x(x), y(y), w(w), h(h) {
+    }
+
+    bool isEmpty() const {
+      return (w <= 0 || h <= 0);
+    }
+  };
+
+  // Range of pixels [x0, x1) in a row (x0 == x1 if it's empty)
+  struct Span {
+    int x0, x1;
+
+    Span() : x0(0), x1(0) {
+    }
+  };
+
+  // Pixels and palette changed in the last Decoder::readFrame()
+  struct FrameChanges {
+    bool colormapChanged;
+    Rect bounds;                  // Bounding box of all changed pixels
+    std::vector<Span> rows;       // Changed pixels in each row
+
+    FrameChanges() : colormapChanged(false) {
+    }
+  };
+
+  struct ChunkInfo {
+    uint32_t offset;              // Position of the chunk in the file
+    uint32_t size;                // Chunk size (including its header)
+    uint16_t type;                // FLI_*_CHUNK (see flic_details.h)
+  };
+
+  struct FrameInfo {
+    uint32_t offset;              // Position of the frame in the file
+    uint32_t size;                // Frame size (including its header)
+    bool keyframe;                // All pixels are replaced
+    bool colorChunk;              // The palette changes
+    std::vector<ChunkInfo> chunks;
+  };
+
+  // Statistics collected by the Decoder/Encoder only when the library
+  // is compiled with the FLIC_STATS option (all zeros in other case)
+  struct Stats {
+    static const int kChunkTypes = 32;
+
+    struct ChunkStats {
+      uint64_t count = 0;
+      uint64_t bytes = 0;         // Bytes read/written (with headers)
+      uint64_t packets = 0;
+      double seconds = 0.0;       // Time decoding/encoding chunks
+    };
+
+    uint64_t frames = 0;          // Frames returned by the Decoder (or written)
+    uint64_t frameBytes = 0;      // Bytes of all frames read/written
+    ChunkStats chunks[kChunkTypes]; // Indexed by chunk type (FLI_*_CHUNK)
+    uint64_t fileReads = 0;       // FileInterface::read8()/read() calls
+    uint64_t fileWrites = 0;      // FileInterface::write8()/write() calls
+    uint64_t fileSeeks = 0;       // FileInterface::seek() calls
+  };
+
   class FileInterface {
   public:
     virtual ~FileInterface() { }
@@ -95,7 +168,9 @@ namespace flic {
     // Current position in the file
     virtual size_t tell() = 0;
 
-    // Jump to the given position in the file
+    // Jump to the given position in the file. If it can jump, ok()
+    // returns true again (e.g. after reading beyond the end of the
+    // file).
     virtual void seek(size_t absPos) = 0;
 
     // Returns the next byte in the file or 0 if ok() = false
@@ -103,6 +178,34 @@ namespace flic {
 
     // Writes one byte in the file (or do nothing if ok() = false)
     virtual void write8(uint8_t value) = 0;
+
+    // Reads "n" bytes from the file into "buf". Bytes that cannot be
+    // read are filled with 0 (and ok() will return false).
+    virtual void read(uint8_t* buf, size_t n) {
+      for (size_t i=0; i<n; ++i)
+        buf[i] = read8();
+    }
+
+    // Writes "n" bytes from "buf" in the file
+    virtual void write(const uint8_t* buf, size_t n) {
+      for (size_t i=0; i<n; ++i)
+        write8(buf[i]);
+    }
+
+    // Returns false if seek() cannot be used (e.g. a pipe). In this
+    // case the Encoder writes the file in one pass, and the number of
+    // frames must be specified in Encoder::writeHeader().
+    virtual bool seekable() const {
+      return true;
+    }
+
+    // Returns a pointer to the whole file content (and its size) if
+    // it's already in memory, or nullptr if the content can only be
+    // accessed through read8()/read().
+    virtual const uint8_t* data(size_t& size) const {
+      size = 0;
+      return nullptr;
+    }
   };
 
   class StdioFileInterface : public flic::FileInterface {
@@ -113,67 +216,268 @@ namespace flic {
     void seek(size_t absPos) override;
     uint8_t read8() override;
     void write8(uint8_t value) override;
+    void read(uint8_t* buf, size_t n) override;
+    void write(const uint8_t* buf, size_t n) override;
+    bool seekable() const override;
 
   private:
     FILE* m_file;
     bool m_ok;
   };
 
+  class MemoryFileInterface : public flic::FileInterface {
+  public:
+    // Read-only access to a buffer owned by the caller
+    MemoryFileInterface(const uint8_t* data, size_t size);
+
+    // Read/write access to a vector owned by the caller, it grows as
+    // we write bytes after its end
+    MemoryFileInterface(std::vector<uint8_t>* buffer);
+
+    bool ok() const override;
+    size_t tell() override;
+    void seek(size_t absPos) override;
+    uint8_t read8() override;
+    void write8(uint8_t value) override;
+    void read(uint8_t* buf, size_t n) override;
+    void write(const uint8_t* buf, size_t n) override;
+    const uint8_t* data(size_t& size) const override;
+
+  protected:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos;
+    std::vector<uint8_t>* m_buffer;
+    bool m_ok;
+  };
+
+  // Maps the whole file in memory (read-only)
+  class MappedFileInterface : public flic::MemoryFileInterface {
+  public:
+    MappedFileInterface(const char* filename);
+    ~MappedFileInterface();
+
+    void seek(size_t absPos) override;
+
+  private:
+    MappedFileInterface(const MappedFileInterface&) = delete;
+    MappedFileInterface& operator=(const MappedFileInterface&) = delete;
+
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+  };
+
+  // Buffers that can be shared by several decoders/encoders (e.g. to
+  // process a lot of files re-using the same memory). It's thread-safe.
+  class BufferPool {
+  public:
+    BufferPool();
+    ~BufferPool();
+
+    // Returns an empty buffer with at least "size" bytes of capacity
+    // (re-using the best buffer from the pool when it's possible)
+    std::vector<uint8_t> take(size_t size);
+
+    // Moves the buffer memory to the pool (the buffer will be empty)
+    void release(std::vector<uint8_t>& buffer);
+
+  private:
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    struct Buffers;
+    std::unique_ptr<Buffers> m_buffers;
+  };
+
   class Decoder {
   public:
-    Decoder(FileInterface* file);
+    // If "pool" is specified, the decoder memory is taken from it
+    // and returned to it when the decoder is destroyed
+    Decoder(FileInterface* file, BufferPool* pool = nullptr);
+    ~Decoder();
     bool readHeader(Header& header);
     bool readFrame(Frame& frame);
 
+    // Reads the header and the frame/chunk headers of the whole file
+    // without decoding pixels (e.g. to inspect a lot of files
+    // quickly). The ring frame is the last element of "frames" if it
+    // exists. Returns false if some frame is missing.
+    bool probe(Header& header, std::vector<FrameInfo>& frames);
+
+    // Walks the frame headers (without decoding them) to create an
+    // index of frame offsets and keyframes. It's called automatically
+    // by seekFrame(), returns false if some frame is missing.
+    bool buildIndex();
+
+    // Decodes the given frame (starting from 0) in "frame", which must
+    // be the same frame used in previous readFrame() calls. It
+    // decodes from the nearest previous keyframe (a frame that
+    // replaces all pixels), and then readFrame() continues with the
+    // next frame.
+    bool seekFrame(int frameIndex, Frame& frame);
+
+    // Enables a cache of decoded frames (pixels and palette) to make
+    // seekFrame() faster. A snapshot is stored each "interval" frames
+    // (when they are decoded), using up to "maxBytes" of memory (0 =
+    // no limit) discarding the least recently used snapshots.
+    void setSnapshotCache(int interval, size_t maxBytes = 0);
+
+    // Tracks the pixels/palette changed in each readFrame() call (or
+    // the whole frame after seekFrame()), e.g. to convert or upload
+    // only the changed pixels.
+    void setTrackChanges(bool state);
+    const FrameChanges& changes() const { return m_changes; }
+
+    // Converts the decoded pixels to the given format in "pixels"
+    // (with "rowstride" bytes per row) in each readFrame() and
+    // seekFrame(). Only changed pixels are converted (it enables
+    // setTrackChanges()), so "pixels" must keep the previous frame.
+    // Use pixels=nullptr to disable the conversion.
+    void setOutput(uint8_t* pixels, int rowstride, PixelFormat format);
+
+    // Decodes only the rows of the given region (whole rows, an empty
+    // rectangle means the whole frame), pixels in other rows are
+    // undefined. BRUN/COPY chunks aren't expanded outside the region.
+    // Delta frames are decoded correctly while the region doesn't
+    // grow; new rows are valid after the next keyframe, or a
+    // seekFrame() call (which decodes them again).
+    void setRegionOfInterest(const Rect& rc);
+    const Rect& regionOfInterest() const { return m_roi; }
+
     int frameCount() const { return m_frameCount; }
 
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
   private:
-    void readChunk(Frame& frame);
+    class ChunkReader;
+
+    struct FrameIndex {
+      uint32_t offset;
+      bool keyframe;            // Has a BRUN, COPY or BLACK chunk
+      bool colorChunk;          // Has a palette change
+    };
+
+    struct Snapshot {
+      int frame;
+      uint64_t lastUse;
+      int validY0, validY1;     // Valid rows (see m_validY0/Y1)
+      std::vector<uint8_t> pixels;
+      Colormap colormap;
+    };
+
+    void readFrameInfos(std::vector<FrameInfo>& frames);
+    void fillIndex(const std::vector<FrameInfo>& frames);
+    Snapshot* findSnapshot(int frameIndex, const Frame& frame);
+    void storeSnapshot(const Frame& frame);
+    bool readNextFrame(Frame& frame);
+    void convertOutput(const Frame& frame);
+    void updateRoiRows();
+    bool roiRowsValid() const;
+    void markChanged(int y, int x0, int x1);
+    void markAllChanged();
+    void updateChangedBounds();
+    void readFrameData(Frame& frame, bool onlyColors);
+    void readChunk(Frame& frame, bool onlyColors);
+    ChunkReader readChunkData(size_t size);
     void readBlackChunk(Frame& frame);
-    void readCopyChunk(Frame& frame);
-    void readColorChunk(Frame& frame, bool oldColorChunk);
-    void readBrunChunk(Frame& frame);
-    void readLcChunk(Frame& frame);
-    void readDeltaChunk(Frame& frame);
+    void readCopyChunk(Frame& frame, ChunkReader& in);
+    void readColorChunk(Frame& frame, ChunkReader& in, bool oldColorChunk);
+    void readBrunChunk(Frame& frame, ChunkReader& in);
+    void readLcChunk(Frame& frame, ChunkReader& in);
+    void readDeltaChunk(Frame& frame, ChunkReader& in);
     uint16_t read16();
     uint32_t read32();
 
     FileInterface* m_file;
+    BufferPool* m_pool;
+    std::vector<uint8_t> m_chunkData;
+    std::vector<FrameIndex> m_index;
+    uint32_t m_fileSize;
     int m_width, m_height;
+    int m_frames;
     int m_frameCount;
     int m_offsetFrame1;
     int m_offsetFrame2;
+    std::vector<Snapshot> m_snapshots;
+    int m_snapshotInterval;
+    size_t m_snapshotMaxBytes;
+    uint64_t m_snapshotUse;
+    bool m_trackChanges;
+    FrameChanges m_changes;
+    uint8_t* m_outputPixels;
+    int m_outputRowstride;
+    PixelFormat m_outputFormat;
+    bool m_outputPaletteValid;
+    uint32_t m_outputPalette[256];
+    Rect m_roi;
+    int m_roiY0, m_roiY1;       // Rows decoded [m_roiY0, m_roiY1)
+    int m_validY0, m_validY1;   // Rows with the pixels of the current frame
+    Stats m_stats;
+    std::unique_ptr<FileInterface> m_statsFile;
   };
 
+  class ThreadPool;
+
   class Encoder {
   public:
-    Encoder(FileInterface* file);
+    // If "pool" is specified, the encoder memory is taken from it
+    // and returned to it when the encoder is destroyed
+    Encoder(FileInterface* file, BufferPool* pool = nullptr);
     ~Encoder();
 
+    // If the file is not seekable, header.frames must contain the
+    // number of frames that will be written (without the ring frame),
+    // and the file size field in the header will be 0.
     void writeHeader(const Header& header);
     void writeFrame(const Frame& frame);
 
+    // Encodes several consecutive frames in parallel and writes them
+    // in order (it's like calling writeFrame() for each one). All
+    // frames must have the same rowstride and their pixels must be
+    // available until the function returns.
+    void writeFrames(const Frame* frames, int nframes);
+
     // Must be called at the end with the first frame. It's required
     // by Animator Pro to loop the animation from the last frame to
     // the first one.
     void writeRingFrame(const Frame& frame);
 
+    // Number of threads used to encode frames (0 = number of cores)
+    void setThreads(int threads);
+
+    // Encodes the lines of big frames in parallel in writeFrame()
+    // (the output is the same as the serial encoding)
+    void setParallelLines(bool state);
+
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
   private:
-    void writeColorChunk(const Frame& frame);
-    void writeBrunChunk(const Frame& frame);
-    void writeBrunLineChunk(const Frame& frame, int y);
-    void writeLcChunk(const Frame& frame);
-    void writeLcLineChunk(const Frame& frame, int y);
-    void write16(uint16_t value);
-    void write32(uint32_t value);
+    class BufferWriter;
+    class FrameEncoder;
+
+    void writeFrameData(const std::vector<uint8_t>& data);
 
     FileInterface* m_file;
+    BufferPool* m_pool;
+    std::vector<uint8_t> m_buffer; // Header (until the first frame is written)
+    std::vector<std::vector<uint8_t>> m_frameBuffers; // Encoded frames
+    uint32_t m_fileSize;
     int m_width, m_height;
     Colormap m_prevColormap;
     std::vector<uint8_t> m_prevFrameData;
     int m_frameCount;
     int m_offsetFrame1;
     int m_offsetFrame2;
+    int m_threads;
+    bool m_parallelLines;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    std::vector<std::vector<uint8_t>> m_bandBuffers; // Lines encoded in parallel
+    Stats m_stats;
+    std::unique_ptr<FileInterface> m_statsFile;
   };
 
 } // namespace flic
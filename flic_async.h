@@ -0,0 +1,79 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_ASYNC_H_INCLUDED
+#define FLIC_ASYNC_H_INCLUDED
+#pragma once
+
+#include "flic.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flic {
+
+  // Decodes frames in a worker thread (ahead of the frame that is
+  // being displayed) into a small ring of frame buffers.
+  class AsyncDecoder {
+  public:
+    // The file must be used only by this AsyncDecoder. "nbuffers" is
+    // the number of frames that can be decoded ahead (plus one).
+    AsyncDecoder(FileInterface* file, int nbuffers = 3);
+    ~AsyncDecoder();
+
+    // Reads the header and starts decoding frames
+    bool readHeader(Header& header);
+
+    // Returns the next decoded frame, which is valid until the next
+    // call to nextFrame() or seekFrame(). If "wait" is false and the
+    // frame is not ready yet, it returns nullptr instead of waiting.
+    // Returns nullptr at the end of the animation too (see end()).
+    const Frame* nextFrame(bool wait = true);
+
+    // Index of the last frame returned by nextFrame()
+    int frameIndex() const { return m_frameIndex; }
+
+    // True if all frames were returned (or there was an error)
+    bool end();
+
+    // Discards the frames decoded ahead and continues decoding from
+    // the given frame
+    void seekFrame(int frameIndex);
+
+  private:
+    struct Slot {
+      std::vector<uint8_t> pixels;
+      Frame frame;
+      int index;
+    };
+
+    void workerLoop();
+
+    Decoder m_decoder;
+    Header m_header;
+    std::vector<Slot> m_slots;
+    int m_lastSlot;             // Slot with the last frame decoded by m_decoder
+    int m_head;                 // Next slot to return in nextFrame()
+    int m_ready;                // Number of decoded slots after m_head
+    bool m_held;                // The user holds the slot before m_head
+    int m_nextFrame;            // Next frame to decode
+    int m_seekFrame;            // Frame requested in seekFrame() (or -1)
+    uint64_t m_generation;      // Incremented on each seekFrame()
+    bool m_finished;            // No more frames to decode
+    bool m_exit;
+    int m_frameIndex;
+    std::mutex m_mutex;
+    std::condition_variable m_workerCv;
+    std::condition_variable m_readyCv;
+    std::thread m_thread;
+  };
+
+} // namespace flic
+
+#endif
@@ -0,0 +1,73 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_BATCH_H_INCLUDED
+#define FLIC_BATCH_H_INCLUDED
+#pragma once
+
+#include "flic.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace flic {
+
+  // Re-encodes a lot of FLI/FLC files as FLC files in parallel (each
+  // file with its own Encoder, which writes palettes only when they
+  // change), sharing a BufferPool between files.
+  class BatchTranscoder {
+  public:
+    struct Job {
+      std::string input;
+      std::string output;
+    };
+
+    struct Result {
+      bool ok = false;
+      int frames = 0;
+      size_t inputBytes = 0;
+      size_t outputBytes = 0;
+      double seconds = 0.0;
+    };
+
+    // "threads" = 0 means the number of cores. "maxMemory" limits the
+    // memory used by the files that are being transcoded at the same
+    // time (0 = no limit).
+    BatchTranscoder(int threads = 0, size_t maxMemory = 0);
+    ~BatchTranscoder();
+
+    // Transcodes all jobs and returns their results (in the same
+    // order). Each job must have a different output file.
+    std::vector<Result> run(const std::vector<Job>& jobs);
+
+    // Maximum memory used by the files transcoded at the same time in
+    // the last run() (it can be more than "maxMemory" only if a file
+    // alone needs more memory)
+    size_t peakMemory() const { return m_peakMemory; }
+
+  private:
+    BatchTranscoder(const BatchTranscoder&) = delete;
+    BatchTranscoder& operator=(const BatchTranscoder&) = delete;
+
+    Result transcode(const Job& job);
+    void acquireMemory(size_t size);
+    void releaseMemory(size_t size);
+
+    std::unique_ptr<ThreadPool> m_threadPool;
+    BufferPool m_bufferPool;
+    size_t m_maxMemory;
+    size_t m_usedMemory;
+    size_t m_peakMemory;
+    std::mutex m_memoryMutex;
+    std::condition_variable m_memoryCv;
+  };
+
+} // namespace flic
+
+#endif
@@ -0,0 +1,37 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_KERNELS_H_INCLUDED
+#define FLIC_KERNELS_H_INCLUDED
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Functions to compare/scan/convert bytes. They use SSE2/AVX2 (selected in
+// runtime depending on the CPU) or NEON when possible, with a scalar
+// fallback for other platforms.
+
+namespace flic {
+
+  // Returns the index of the first byte that is different in "a"
+  // and "b", or "n" if both buffers are equal.
+  size_t first_diff(const uint8_t* a, const uint8_t* b, size_t n);
+
+  // Returns the number of consecutive bytes equal to p[0] (0 if n=0)
+  size_t equal_run(const uint8_t* p, size_t n);
+
+  inline bool equal_bytes(const uint8_t* a, const uint8_t* b, size_t n) {
+    return (first_diff(a, b, n) == n);
+  }
+
+  // Converts "n" indexes to 32-bit values using the given table
+  // (with 256 entries)
+  void lookup32(const uint8_t* src, uint32_t* dst, size_t n, const uint32_t* table);
+
+} // namespace flic
+
+#endif
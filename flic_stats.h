@@ -0,0 +1,110 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_STATS_H_INCLUDED
+#define FLIC_STATS_H_INCLUDED
+#pragma once
+
+#include "flic.h"
+
+// Statistics are collected only if the library is compiled with
+// FLIC_STATS=1 (FLIC_STATS option in CMake), in other case this
+// generates no code.
+
+#if FLIC_STATS
+  #include <chrono>
+  #define FLIC_STATS_ADD(var, value) ((var) += (value))
+#else
+  #define FLIC_STATS_ADD(var, value) ((void)0)
+#endif
+
+#if FLIC_STATS
+
+namespace flic {
+
+  typedef std::chrono::steady_clock::time_point StatsTime;
+
+  inline StatsTime stats_now() {
+    return std::chrono::steady_clock::now();
+  }
+
+  inline double stats_seconds_since(const StatsTime& t0) {
+    return std::chrono::duration<double>(stats_now() - t0).count();
+  }
+
+  inline void add_chunk_stats(Stats& stats, int type, uint64_t bytes,
+                              uint64_t packets, double seconds) {
+    if (type > 0 && type < Stats::kChunkTypes) {
+      Stats::ChunkStats& chunk = stats.chunks[type];
+      ++chunk.count;
+      chunk.bytes += bytes;
+      chunk.packets += packets;
+      chunk.seconds += seconds;
+    }
+  }
+
+  inline void add_stats(Stats& a, const Stats& b) {
+    a.frames += b.frames;
+    a.frameBytes += b.frameBytes;
+    for (int i=0; i<Stats::kChunkTypes; ++i) {
+      a.chunks[i].count += b.chunks[i].count;
+      a.chunks[i].bytes += b.chunks[i].bytes;
+      a.chunks[i].packets += b.chunks[i].packets;
+      a.chunks[i].seconds += b.chunks[i].seconds;
+    }
+    a.fileReads += b.fileReads;
+    a.fileWrites += b.fileWrites;
+    a.fileSeeks += b.fileSeeks;
+  }
+
+  // Counts the calls to the given file
+  class StatsFileInterface : public FileInterface {
+  public:
+    StatsFileInterface(FileInterface* file, Stats& stats)
+      : m_file(file)
+      , m_stats(stats) {
+    }
+
+    bool ok() const override { return m_file->ok(); }
+    size_t tell() override { return m_file->tell(); }
+    bool seekable() const override { return m_file->seekable(); }
+    const uint8_t* data(size_t& size) const override { return m_file->data(size); }
+
+    void seek(size_t absPos) override {
+      ++m_stats.fileSeeks;
+      m_file->seek(absPos);
+    }
+
+    uint8_t read8() override {
+      ++m_stats.fileReads;
+      return m_file->read8();
+    }
+
+    void read(uint8_t* buf, size_t n) override {
+      ++m_stats.fileReads;
+      m_file->read(buf, n);
+    }
+
+    void write8(uint8_t value) override {
+      ++m_stats.fileWrites;
+      m_file->write8(value);
+    }
+
+    void write(const uint8_t* buf, size_t n) override {
+      ++m_stats.fileWrites;
+      m_file->write(buf, n);
+    }
+
+  private:
+    FileInterface* m_file;
+    Stats& m_stats;
+  };
+
+} // namespace flic
+
+#endif // FLIC_STATS
+
+#endif
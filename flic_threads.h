@@ -0,0 +1,62 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_THREADS_H_INCLUDED
+#define FLIC_THREADS_H_INCLUDED
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace flic {
+
+  // Fixed set of worker threads to run loop iterations in parallel.
+  class ThreadPool {
+  public:
+    // "threads" includes the thread that calls parallelFor() (so
+    // threads-1 workers are created), 0 means the number of cores.
+    ThreadPool(int threads);
+    ~ThreadPool();
+
+    int threads() const { return int(m_workers.size())+1; }
+
+    // Calls func(i) for each i in [0, n) and waits all calls to
+    // finish. The calling thread runs iterations too. It cannot be
+    // called from "func" (nested loops must run serially).
+    template<typename Func>
+    void parallelFor(int n, Func&& func) {
+      typedef typename std::remove_reference<Func>::type F;
+      run(n, [](void* data, int i){ (*(F*)data)(i); }, (void*)&func);
+    }
+
+  private:
+    typedef void (*IterationFunc)(void* data, int i);
+
+    void run(int n, IterationFunc func, void* data);
+    void workerLoop();
+    void runIterations();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_doneCv;
+    IterationFunc m_func;
+    void* m_data;
+    int m_n;
+    std::atomic<int> m_next;
+    int m_busyWorkers;
+    uint64_t m_generation;
+    bool m_exit;
+  };
+
+} // namespace flic
+
+#endif
@@ -0,0 +1,256 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define FLIC_SIMD_X86 1
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define FLIC_SIMD_NEON 1
+  #include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+  #define FLIC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define FLIC_TARGET_AVX2
+#endif
+
+namespace flic {
+
+typedef size_t (*FirstDiffFunc)(const uint8_t* a, const uint8_t* b, size_t n);
+typedef size_t (*FirstDiffValueFunc)(const uint8_t* p, uint8_t value, size_t n);
+typedef void (*Lookup32Func)(const uint8_t* src, uint32_t* dst, size_t n, const uint32_t* table);
+
+//////////////////////////////////////////////////////////////////////
+// Scalar versions
+
+static size_t first_diff_scalar(const uint8_t* a, const uint8_t* b, size_t n)
+{
+  size_t i = 0;
+  while (i < n && a[i] == b[i])
+    ++i;
+  return i;
+}
+
+static size_t first_diff_value_scalar(const uint8_t* p, uint8_t value, size_t n)
+{
+  size_t i = 0;
+  while (i < n && p[i] == value)
+    ++i;
+  return i;
+}
+
+static void lookup32_scalar(const uint8_t* src, uint32_t* dst, size_t n, const uint32_t* table)
+{
+  size_t i = 0;
+  for (; i+4 <= n; i += 4) {
+    dst[i  ] = table[src[i  ]];
+    dst[i+1] = table[src[i+1]];
+    dst[i+2] = table[src[i+2]];
+    dst[i+3] = table[src[i+3]];
+  }
+  for (; i<n; ++i)
+    dst[i] = table[src[i]];
+}
+
+#if FLIC_SIMD_X86
+
+static inline int count_trailing_zeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+  unsigned long i;
+  _BitScanForward(&i, mask);
+  return int(i);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+static bool has_avx2()
+{
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  // AVX must be supported by the CPU and enabled by the OS
+  __cpuid(info, 1);
+  const int osxsave = (1 << 27);
+  const int avx = (1 << 28);
+  if ((info[2] & (osxsave | avx)) != (osxsave | avx) ||
+      (_xgetbv(0) & 6) != 6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+// SSE2 versions (always available on x86-64)
+
+static size_t first_diff_sse2(const uint8_t* a, const uint8_t* b, size_t n)
+{
+  size_t i = 0;
+  for (; i+16 <= n; i += 16) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+    uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xffff;
+    if (mask)
+      return i + count_trailing_zeros(mask);
+  }
+  return i + first_diff_scalar(a+i, b+i, n-i);
+}
+
+static size_t first_diff_value_sse2(const uint8_t* p, uint8_t value, size_t n)
+{
+  const __m128i v = _mm_set1_epi8(char(value));
+  size_t i = 0;
+  for (; i+16 <= n; i += 16) {
+    __m128i vp = _mm_loadu_si128((const __m128i*)(p+i));
+    uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(vp, v)) ^ 0xffff;
+    if (mask)
+      return i + count_trailing_zeros(mask);
+  }
+  return i + first_diff_value_scalar(p+i, value, n-i);
+}
+
+//////////////////////////////////////////////////////////////////////
+// AVX2 versions
+
+FLIC_TARGET_AVX2
+static size_t first_diff_avx2(const uint8_t* a, const uint8_t* b, size_t n)
+{
+  size_t i = 0;
+  for (; i+32 <= n; i += 32) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a+i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b+i));
+    uint32_t mask = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+    if (mask)
+      return i + count_trailing_zeros(mask);
+  }
+  return i + first_diff_sse2(a+i, b+i, n-i);
+}
+
+FLIC_TARGET_AVX2
+static size_t first_diff_value_avx2(const uint8_t* p, uint8_t value, size_t n)
+{
+  const __m256i v = _mm256_set1_epi8(char(value));
+  size_t i = 0;
+  for (; i+32 <= n; i += 32) {
+    __m256i vp = _mm256_loadu_si256((const __m256i*)(p+i));
+    uint32_t mask = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(vp, v)));
+    if (mask)
+      return i + count_trailing_zeros(mask);
+  }
+  return i + first_diff_value_sse2(p+i, value, n-i);
+}
+
+FLIC_TARGET_AVX2
+static void lookup32_avx2(const uint8_t* src, uint32_t* dst, size_t n, const uint32_t* table)
+{
+  size_t i = 0;
+  for (; i+8 <= n; i += 8) {
+    __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src+i)));
+    __m256i colors = _mm256_i32gather_epi32((const int*)table, index, 4);
+    _mm256_storeu_si256((__m256i*)(dst+i), colors);
+  }
+  lookup32_scalar(src+i, dst+i, n-i, table);
+}
+
+#elif FLIC_SIMD_NEON
+
+//////////////////////////////////////////////////////////////////////
+// NEON versions
+
+static size_t first_diff_neon(const uint8_t* a, const uint8_t* b, size_t n)
+{
+  size_t i = 0;
+  for (; i+16 <= n; i += 16) {
+    uint8x16_t eq = vceqq_u8(vld1q_u8(a+i), vld1q_u8(b+i));
+    if (vminvq_u8(eq) != 0xff)
+      break;
+  }
+  return i + first_diff_scalar(a+i, b+i, n-i);
+}
+
+static size_t first_diff_value_neon(const uint8_t* p, uint8_t value, size_t n)
+{
+  const uint8x16_t v = vdupq_n_u8(value);
+  size_t i = 0;
+  for (; i+16 <= n; i += 16) {
+    uint8x16_t eq = vceqq_u8(vld1q_u8(p+i), v);
+    if (vminvq_u8(eq) != 0xff)
+      break;
+  }
+  return i + first_diff_value_scalar(p+i, value, n-i);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// Dispatch
+
+static FirstDiffFunc get_first_diff_func()
+{
+#if FLIC_SIMD_X86
+  return (has_avx2() ? first_diff_avx2: first_diff_sse2);
+#elif FLIC_SIMD_NEON
+  return first_diff_neon;
+#else
+  return first_diff_scalar;
+#endif
+}
+
+static FirstDiffValueFunc get_first_diff_value_func()
+{
+#if FLIC_SIMD_X86
+  return (has_avx2() ? first_diff_value_avx2: first_diff_value_sse2);
+#elif FLIC_SIMD_NEON
+  return first_diff_value_neon;
+#else
+  return first_diff_value_scalar;
+#endif
+}
+
+static Lookup32Func get_lookup32_func()
+{
+#if FLIC_SIMD_X86
+  return (has_avx2() ? lookup32_avx2: lookup32_scalar);
+#else
+  return lookup32_scalar;
+#endif
+}
+
+size_t first_diff(const uint8_t* a, const uint8_t* b, size_t n)
+{
+  static const FirstDiffFunc func = get_first_diff_func();
+  return func(a, b, n);
+}
+
+size_t equal_run(const uint8_t* p, size_t n)
+{
+  static const FirstDiffValueFunc func = get_first_diff_value_func();
+  if (n == 0)
+    return 0;
+  return 1 + func(p+1, p[0], n-1);
+}
+
+void lookup32(const uint8_t* src, uint32_t* dst, size_t n, const uint32_t* table)
+{
+  static const Lookup32Func func = get_lookup32_func();
+  func(src, dst, n, table);
+}
+
+} // namespace flic
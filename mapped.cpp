@@ -0,0 +1,96 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace flic {
+
+MappedFileInterface::MappedFileInterface(const char* filename)
+  : MemoryFileInterface(nullptr, 0)
+#ifdef _WIN32
+  , m_fileHandle(INVALID_HANDLE_VALUE)
+  , m_mappingHandle(nullptr)
+#endif
+{
+  m_ok = false;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+  m_fileHandle = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    return;
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                      0, 0, nullptr);
+  if (!mapping)
+    return;
+  m_mappingHandle = mapping;
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view)
+    return;
+
+  m_data = (const uint8_t*)view;
+  m_size = size_t(size.QuadPart);
+  m_ok = true;
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      m_data = (const uint8_t*)addr;
+      m_size = size_t(st.st_size);
+      m_ok = true;
+    }
+  }
+
+  // The mapping keeps a reference to the file
+  close(fd);
+#endif
+}
+
+MappedFileInterface::~MappedFileInterface()
+{
+#ifdef _WIN32
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mappingHandle)
+    CloseHandle(m_mappingHandle);
+  if (m_fileHandle != INVALID_HANDLE_VALUE)
+    CloseHandle(m_fileHandle);
+#else
+  if (m_data)
+    munmap((void*)m_data, m_size);
+#endif
+}
+
+void MappedFileInterface::seek(size_t absPos)
+{
+  // A file that couldn't be mapped is never ok()
+  if (m_data)
+    MemoryFileInterface::seek(absPos);
+}
+
+} // namespace flic
@@ -0,0 +1,99 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic.h"
+
+#include <algorithm>
+
+namespace flic {
+
+MemoryFileInterface::MemoryFileInterface(const uint8_t* data, size_t size)
+  : m_data(data)
+  , m_size(size)
+  , m_pos(0)
+  , m_buffer(nullptr)
+  , m_ok(true)
+{
+}
+
+MemoryFileInterface::MemoryFileInterface(std::vector<uint8_t>* buffer)
+  : m_data(buffer->data())
+  , m_size(buffer->size())
+  , m_pos(0)
+  , m_buffer(buffer)
+  , m_ok(true)
+{
+}
+
+bool MemoryFileInterface::ok() const
+{
+  return m_ok;
+}
+
+size_t MemoryFileInterface::tell()
+{
+  return m_pos;
+}
+
+void MemoryFileInterface::seek(size_t absPos)
+{
+  m_pos = absPos;
+  m_ok = true;
+}
+
+uint8_t MemoryFileInterface::read8()
+{
+  if (m_pos < m_size)
+    return m_data[m_pos++];
+
+  m_ok = false;
+  return 0;
+}
+
+void MemoryFileInterface::write8(uint8_t value)
+{
+  write(&value, 1);
+}
+
+void MemoryFileInterface::read(uint8_t* buf, size_t n)
+{
+  size_t available = (m_pos < m_size ? std::min(n, m_size-m_pos): 0);
+  std::copy(m_data+m_pos, m_data+m_pos+available, buf);
+  m_pos += available;
+
+  if (available < n) {
+    std::fill(buf+available, buf+n, 0);
+    m_ok = false;
+  }
+}
+
+void MemoryFileInterface::write(const uint8_t* buf, size_t n)
+{
+  // Read-only buffer
+  if (!m_buffer) {
+    m_ok = false;
+    return;
+  }
+
+  // Like a regular file, the gap between the end of the buffer and
+  // the current position is filled with zeros
+  if (m_buffer->size() < m_pos+n)
+    m_buffer->resize(m_pos+n);
+
+  std::copy(buf, buf+n, m_buffer->begin()+m_pos);
+  m_pos += n;
+
+  m_data = m_buffer->data();
+  m_size = m_buffer->size();
+}
+
+const uint8_t* MemoryFileInterface::data(size_t& size) const
+{
+  size = m_size;
+  return m_data;
+}
+
+} // namespace flic
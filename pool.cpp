@@ -0,0 +1,71 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic.h"
+
+#include <mutex>
+#include <utility>
+
+namespace flic {
+
+struct BufferPool::Buffers {
+  std::mutex mutex;
+  std::vector<std::vector<uint8_t>> list;
+};
+
+BufferPool::BufferPool()
+  : m_buffers(new Buffers)
+{
+}
+
+BufferPool::~BufferPool()
+{
+}
+
+std::vector<uint8_t> BufferPool::take(size_t size)
+{
+  std::vector<uint8_t> buffer;
+  {
+    std::lock_guard<std::mutex> lock(m_buffers->mutex);
+    std::vector<std::vector<uint8_t>>& buffers = m_buffers->list;
+
+    // Smallest buffer with enough capacity, or the biggest one
+    int best = -1;
+    for (int i=0; i<int(buffers.size()); ++i) {
+      const size_t capacity = buffers[i].capacity();
+      if (best >= 0) {
+        const size_t bestCapacity = buffers[best].capacity();
+        if (bestCapacity >= size ? (capacity >= size && capacity < bestCapacity):
+                                   (capacity > bestCapacity))
+          best = i;
+      }
+      else
+        best = i;
+    }
+
+    if (best >= 0) {
+      buffer = std::move(buffers[best]);
+      if (best != int(buffers.size())-1)
+        buffers[best] = std::move(buffers.back());
+      buffers.pop_back();
+    }
+  }
+
+  buffer.clear();
+  buffer.reserve(size);
+  return buffer;
+}
+
+void BufferPool::release(std::vector<uint8_t>& buffer)
+{
+  if (buffer.capacity() > 0) {
+    std::lock_guard<std::mutex> lock(m_buffers->mutex);
+    m_buffers->list.push_back(std::move(buffer));
+  }
+  buffer.clear();
+}
+
+} // namespace flic
@@ -1,4 +1,5 @@
 // Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
 // Copyright (c) 2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -6,6 +7,8 @@
 
 #include "flic.h"
 
+#include <algorithm>
+
 namespace flic {
 
 StdioFileInterface::StdioFileInterface(FILE* file)
@@ -26,7 +29,10 @@ size_t StdioFileInterface::tell()
 
 void StdioFileInterface::seek(size_t absPos)
 {
-  fseek(m_file, absPos, SEEK_SET);
+  // Like fseek() clears the end-of-file indicator, we can read again
+  // after trying to read beyond the end of the file
+  if (fseek(m_file, absPos, SEEK_SET) == 0)
+    m_ok = true;
 }
 
 uint8_t StdioFileInterface::read8()
@@ -44,4 +50,24 @@ void StdioFileInterface::write8(uint8_t value)
   fputc(value, m_file);
 }
 
+void StdioFileInterface::read(uint8_t* buf, size_t n)
+{
+  size_t read = fread(buf, 1, n, m_file);
+  if (read != n) {
+    std::fill(buf+read, buf+n, 0);
+    m_ok = false;
+  }
+}
+
+void StdioFileInterface::write(const uint8_t* buf, size_t n)
+{
+  fwrite(buf, 1, n, m_file);
+}
+
+bool StdioFileInterface::seekable() const
+{
+  // ftell() fails for pipes
+  return (ftell(m_file) >= 0);
+}
+
 } // namespace flic
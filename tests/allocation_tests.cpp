@@ -0,0 +1,125 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts all heap allocations of the flic-tests executable
+static std::atomic<int> allocations(0);
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  if (void* ptr = std::malloc(size ? size: 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+Animation small_changes(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width);
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  for (uint8_t& p : pixels)
+    p = uint8_t(rnd.next(4));
+  for (int f=0; f<frames; ++f) {
+    for (int k=0; k<200; ++k)
+      pixels[rnd.next(width*height)] = uint8_t(rnd.next());
+    Colormap colormap = gray_colormap();
+    colormap[f] = Color(255, 0, 0);
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+// Encoding/decoding files with a shared BufferPool must not allocate
+// memory in writeFrame()/readFrame() after the first frames
+TEST(allocation_free_steady_state)
+{
+  const int kWarmUpFrames = 2;
+  const Animation anim = small_changes(160, 120, 12);
+  std::vector<Frame> frames;
+  for (int i=0; i<anim.frames(); ++i)
+    frames.push_back(make_frame(anim, i));
+
+  BufferPool pool;
+  {
+    // The counter works with allocations from the library
+    const int before = allocations;
+    std::vector<uint8_t> buffer = pool.take(16);
+    EXPECT(allocations > before);
+    pool.release(buffer);
+  }
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+
+  for (int file=0; file<3; ++file) {
+    std::vector<uint8_t> data = pool.take(1024*1024);
+    int encodeAllocs = 0;
+    {
+      MemoryFileInterface output(&data);
+      Encoder encoder(&output, &pool);
+      Header header;
+      header.frames = anim.frames();
+      header.width = anim.width;
+      header.height = anim.height;
+      header.speed = 50;
+      encoder.writeHeader(header);
+      for (int i=0; i<anim.frames(); ++i) {
+        const int before = allocations;
+        encoder.writeFrame(frames[i]);
+        if (i >= kWarmUpFrames)
+          encodeAllocs += allocations - before;
+      }
+      encoder.writeRingFrame(frames[0]);
+    }
+    EXPECT(encodeAllocs == 0);
+
+    int decodeAllocs = 0;
+    {
+      MemoryFileInterface input(data.data(), data.size());
+      Decoder decoder(&input, &pool);
+      Header header;
+      EXPECT(decoder.readHeader(header));
+      Frame frame;
+      frame.pixels = pixels.data();
+      frame.rowstride = anim.width;
+      for (int i=0; i<anim.frames(); ++i) {
+        const int before = allocations;
+        decoder.readFrame(frame);
+        if (i >= kWarmUpFrames)
+          decodeAllocs += allocations - before;
+        EXPECT(pixels == anim.pixels[i]);
+      }
+    }
+    EXPECT(decodeAllocs == 0);
+
+    pool.release(data);
+  }
+}
@@ -0,0 +1,175 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_TESTS_ANIMATIONS_H_INCLUDED
+#define FLIC_TESTS_ANIMATIONS_H_INCLUDED
+#pragma once
+
+#include "../flic.h"
+
+#include <algorithm>
+#include <vector>
+
+// Synthetic animations (and functions to encode them) used by
+// flic-tests and flic-bench
+
+namespace flic_tests {
+
+  // Deterministic random numbers (the same values in all platforms,
+  // so encoded sizes can be compared between runs)
+  class Random {
+  public:
+    Random(uint32_t seed) : m_state(seed*2654435761u + 1) { }
+
+    uint32_t next() {
+      m_state ^= m_state << 13;
+      m_state ^= m_state >> 17;
+      m_state ^= m_state << 5;
+      return m_state;
+    }
+
+    int next(int n) { return int(next() % uint32_t(n)); }
+
+  private:
+    uint32_t m_state;
+  };
+
+  struct Animation {
+    int width = 0;
+    int height = 0;
+    std::vector<std::vector<uint8_t>> pixels; // Pixels of each frame
+    std::vector<flic::Colormap> colormaps;    // Palette of each frame
+
+    int frames() const { return int(pixels.size()); }
+  };
+
+  inline flic::Colormap gray_colormap() {
+    flic::Colormap colormap;
+    for (int i=0; i<flic::Colormap::SIZE; ++i)
+      colormap[i] = flic::Color(i, 255-i, (i*3) & 255);
+    return colormap;
+  }
+
+  inline flic::Frame make_frame(const Animation& anim, int i) {
+    flic::Frame frame;
+    frame.pixels = const_cast<uint8_t*>(anim.pixels[i].data());
+    frame.rowstride = anim.width;
+    frame.colormap = anim.colormaps[i];
+    return frame;
+  }
+
+  // Encodes all frames of the animation (plus the ring frame)
+  inline void encode(const Animation& anim, flic::Encoder& encoder) {
+    flic::Header header;
+    header.frames = anim.frames();
+    header.width = anim.width;
+    header.height = anim.height;
+    header.speed = 50;
+    encoder.writeHeader(header);
+    for (int i=0; i<anim.frames(); ++i)
+      encoder.writeFrame(make_frame(anim, i));
+    encoder.writeRingFrame(make_frame(anim, 0));
+  }
+
+  inline std::vector<uint8_t> encode(const Animation& anim) {
+    std::vector<uint8_t> data;
+    flic::MemoryFileInterface file(&data);
+    {
+      flic::Encoder encoder(&file);
+      encode(anim, encoder);
+    }
+    return data;
+  }
+
+  enum Scenario {
+    Noise,
+    Flat,
+    Sprite,
+    PaletteCycling,
+    SceneCuts,
+    Runs,
+    BlackFrames,
+  };
+
+  inline const char* scenario_name(Scenario scenario) {
+    static const char* names[] = {
+      "noise", "flat", "sprite", "palcycle", "scenecut", "runs", "black",
+    };
+    return names[scenario];
+  }
+
+  // Generates a synthetic animation of the given kind
+  inline Animation make_animation(Scenario scenario, int width, int height, int frames) {
+    Animation anim;
+    anim.width = width;
+    anim.height = height;
+
+    Random rnd(width*7 + height + scenario);
+    const flic::Colormap base = gray_colormap();
+    flic::Colormap colormap = base;
+    std::vector<uint8_t> pixels(size_t(width)*height, 0);
+    const int npixels = width*height;
+
+    for (int f=0; f<frames; ++f) {
+      switch (scenario) {
+        case Noise:
+          for (uint8_t& p : pixels)
+            p = uint8_t(rnd.next());
+          break;
+        case Flat:
+          std::fill(pixels.begin(), pixels.end(), uint8_t(f*17));
+          break;
+        case Sprite:
+          std::fill(pixels.begin(), pixels.end(), 3);
+          for (int y=0; y<20 && y<height; ++y)
+            for (int x=0; x<24 && x<width; ++x)
+              pixels[((y+f*3) % height)*width + (x+f*5) % width] = uint8_t((x ^ y) + f);
+          break;
+        case PaletteCycling:
+          if (f == 0) {
+            for (int i=0; i<npixels; ++i)
+              pixels[i] = uint8_t(i);
+          }
+          for (int i=0; i<flic::Colormap::SIZE; ++i)
+            colormap[i] = base[(i+f) % flic::Colormap::SIZE];
+          break;
+        case SceneCuts:
+          if (f % 3 == 0) {
+            for (uint8_t& p : pixels)
+              if (rnd.next(4) == 0)
+                p = uint8_t(rnd.next());
+          }
+          else {
+            for (int k=0; k<50; ++k)
+              pixels[rnd.next(npixels)] = uint8_t(rnd.next());
+          }
+          break;
+        case Runs:
+          for (int i=0; i<npixels; ) {
+            const int n = 1 + rnd.next(9);
+            const uint8_t color = uint8_t(rnd.next());
+            for (int k=0; k<n && i<npixels; ++k)
+              pixels[i++] = color;
+          }
+          break;
+        case BlackFrames:
+          if (f & 1)
+            std::fill(pixels.begin(), pixels.end(), 0);
+          else {
+            for (uint8_t& p : pixels)
+              p = (rnd.next(5) == 0 ? uint8_t(rnd.next()): 7);
+          }
+          break;
+      }
+      anim.pixels.push_back(pixels);
+      anim.colormaps.push_back(colormap);
+    }
+    return anim;
+  }
+
+} // namespace flic_tests
+
+#endif
@@ -0,0 +1,246 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+#include "../flic_async.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Moving sprite with a keyframe each 10 frames and a palette change
+// each 3 frames
+Animation sprite_frames(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width*height);
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  Colormap colormap = gray_colormap();
+  for (int f=0; f<frames; ++f) {
+    if (f % 10 == 0) {
+      for (uint8_t& p : pixels)
+        p = uint8_t(rnd.next(4));
+    }
+    for (int y=0; y<12 && y<height; ++y)
+      for (int x=0; x<12 && x<width; ++x)
+        pixels[((y+f*3) % height)*width + (x+f*5) % width] = uint8_t((x ^ y) + f);
+    if (f % 3 == 0)
+      colormap[0] = Color(f, 0, 255-f);
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+// Read-only file without data() (so all bytes are read with read())
+// which can block the reads of frames, and saves the last byte that
+// was read
+class WatchedFile : public FileInterface {
+public:
+  WatchedFile(const std::vector<uint8_t>& data) : m_file(data.data(), data.size()) { }
+
+  size_t maxPos() const { return m_maxPos; }
+
+  void block(bool state) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_blocked = state;
+    }
+    m_cv.notify_all();
+  }
+
+  bool ok() const override { return m_file.ok(); }
+  size_t tell() override { return m_file.tell(); }
+  void seek(size_t absPos) override { m_file.seek(absPos); }
+  void write8(uint8_t) override { }
+
+  uint8_t read8() override {
+    uint8_t value;
+    read(&value, 1);
+    return value;
+  }
+
+  void read(uint8_t* buf, size_t n) override {
+    const size_t pos = m_file.tell();
+    if (pos >= 128) {           // Frames are after the header
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this]{ return !m_blocked; });
+    }
+    m_file.read(buf, n);
+    m_maxPos = std::max<size_t>(m_maxPos, pos+n);
+  }
+
+private:
+  MemoryFileInterface m_file;
+  std::atomic<size_t> m_maxPos { 0 };
+  bool m_blocked = false;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+};
+
+// End of each frame in the file
+std::vector<size_t> frame_ends(const std::vector<uint8_t>& data)
+{
+  MemoryFileInterface file(data.data(), data.size());
+  Decoder decoder(&file);
+  Header header;
+  std::vector<FrameInfo> frames;
+  decoder.probe(header, frames);
+
+  std::vector<size_t> ends;
+  for (const FrameInfo& frame : frames)
+    ends.push_back(frame.offset + frame.size);
+  return ends;
+}
+
+// Waits until the worker reads up to the given position (or a
+// timeout)
+void wait_reads(const WatchedFile& file, size_t pos)
+{
+  for (int i=0; i<200 && file.maxPos() < pos; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+bool frame_matches(const Animation& anim, const Frame* frame, int i)
+{
+  return (frame &&
+          std::equal(anim.pixels[i].begin(), anim.pixels[i].end(), frame->pixels) &&
+          frame->colormap == anim.colormaps[i]);
+}
+
+} // anonymous namespace
+
+TEST(async_frames_in_order)
+{
+  const Animation anim = sprite_frames(67, 41, 25);
+  const std::vector<uint8_t> data = encode(anim);
+
+  for (int nbuffers=1; nbuffers<=5; ++nbuffers) {
+    MemoryFileInterface file(data.data(), data.size());
+    AsyncDecoder decoder(&file, nbuffers);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+    EXPECT(header.frames == anim.frames());
+
+    for (int i=0; i<anim.frames(); ++i) {
+      const Frame* frame = decoder.nextFrame();
+      EXPECT(frame_matches(anim, frame, i));
+      EXPECT(decoder.frameIndex() == i);
+    }
+    EXPECT(decoder.nextFrame() == nullptr);
+    EXPECT(decoder.end());
+  }
+}
+
+// The worker stops when all frame buffers are in use
+TEST(async_full_ring)
+{
+  const Animation anim = sprite_frames(64, 48, 12);
+  const std::vector<uint8_t> data = encode(anim);
+  const std::vector<size_t> ends = frame_ends(data);
+
+  WatchedFile file(data);
+  AsyncDecoder decoder(&file, 3);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+
+  // Three frames decoded ahead (and not one more)
+  wait_reads(file, ends[2]);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT(file.maxPos() == ends[2]);
+
+  // The first frame is in use (so it cannot be re-used yet)
+  EXPECT(frame_matches(anim, decoder.nextFrame(), 0));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT(file.maxPos() == ends[2]);
+
+  // The first frame is released, so one more frame is decoded
+  EXPECT(frame_matches(anim, decoder.nextFrame(), 1));
+  wait_reads(file, ends[3]);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT(file.maxPos() == ends[3]);
+
+  for (int i=2; i<anim.frames(); ++i)
+    EXPECT(frame_matches(anim, decoder.nextFrame(), i));
+  EXPECT(decoder.nextFrame() == nullptr);
+}
+
+TEST(async_seek_while_ahead)
+{
+  const Animation anim = sprite_frames(64, 48, 40);
+  const std::vector<uint8_t> data = encode(anim);
+  const std::vector<size_t> ends = frame_ends(data);
+
+  WatchedFile file(data);
+  AsyncDecoder decoder(&file, 4);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+  EXPECT(frame_matches(anim, decoder.nextFrame(), 0));
+  wait_reads(file, ends[4]);
+
+  // Forward (from a delta frame), backwards, to a keyframe
+  const int seeks[] = { 17, 3, 30, 29, 0, 10 };
+  for (int i : seeks) {
+    decoder.seekFrame(i);
+    for (int j=i; j<i+3; ++j) {
+      EXPECT(frame_matches(anim, decoder.nextFrame(), j));
+      EXPECT(decoder.frameIndex() == j);
+    }
+  }
+
+  // Seek twice without reading frames
+  decoder.seekFrame(5);
+  decoder.seekFrame(38);
+  EXPECT(frame_matches(anim, decoder.nextFrame(), 38));
+  EXPECT(frame_matches(anim, decoder.nextFrame(), 39));
+  EXPECT(decoder.nextFrame() == nullptr);
+  EXPECT(decoder.end());
+}
+
+TEST(async_no_wait_empty_ring)
+{
+  const Animation anim = sprite_frames(32, 32, 5);
+  const std::vector<uint8_t> data = encode(anim);
+
+  WatchedFile file(data);
+  file.block(true);
+  AsyncDecoder decoder(&file, 3);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+
+  // The worker cannot read the first frame
+  EXPECT(decoder.nextFrame(false) == nullptr);
+  EXPECT(!decoder.end());
+
+  file.block(false);
+  EXPECT(frame_matches(anim, decoder.nextFrame(), 0));
+  EXPECT(decoder.frameIndex() == 0);
+
+  // Poll the rest of frames
+  int i = 1;
+  for (int tries=0; i<anim.frames() && tries<1000; ++tries) {
+    const Frame* frame = decoder.nextFrame(false);
+    if (frame) {
+      EXPECT(frame_matches(anim, frame, i));
+      ++i;
+    }
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT(i == anim.frames());
+  EXPECT(decoder.nextFrame() == nullptr);
+  EXPECT(decoder.end());
+}
@@ -0,0 +1,125 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+#include "../flic_batch.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+Animation scrolling_bars(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  Colormap colormap = gray_colormap();
+  for (int f=0; f<frames; ++f) {
+    for (int y=0; y<height; ++y)
+      for (int x=0; x<width; ++x)
+        pixels[y*width + x] = uint8_t((x+f) / 8 + y / 16);
+    colormap[f & 255] = Color(255, f, 0);
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+bool write_file(const char* filename, const std::vector<uint8_t>& data)
+{
+  FILE* f = std::fopen(filename, "wb");
+  if (!f)
+    return false;
+  const bool ok = (std::fwrite(data.data(), 1, data.size(), f) == data.size());
+  return (std::fclose(f) == 0 && ok);
+}
+
+std::vector<uint8_t> read_file(const char* filename)
+{
+  std::vector<uint8_t> data;
+  if (FILE* f = std::fopen(filename, "rb")) {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+      data.insert(data.end(), buf, buf+n);
+    std::fclose(f);
+  }
+  return data;
+}
+
+} // anonymous namespace
+
+TEST(batch_transcode_files)
+{
+  const Animation anims[] = {
+    scrolling_bars(320, 200, 12),
+    scrolling_bars(97, 301, 7),
+  };
+  const char* inputs[] = { "flic-tests-batch-a.flc", "flic-tests-batch-b.flc" };
+  const char* outputs[] = { "flic-tests-batch-a.out.flc", "flic-tests-batch-b.out.flc" };
+
+  std::vector<BatchTranscoder::Job> jobs;
+  for (int i=0; i<2; ++i) {
+    EXPECT(write_file(inputs[i], encode(anims[i])));
+    BatchTranscoder::Job job;
+    job.input = inputs[i];
+    job.output = outputs[i];
+    jobs.push_back(job);
+  }
+
+  // Memory needed by each file alone
+  size_t fileMemory[2];
+  for (int i=0; i<2; ++i) {
+    BatchTranscoder transcoder(1);
+    const auto results = transcoder.run({ jobs[i] });
+    EXPECT(results.size() == 1 && results[0].ok);
+    fileMemory[i] = transcoder.peakMemory();
+    EXPECT(fileMemory[i] > 0);
+  }
+
+  // Without memory limit, with enough memory for both files, and
+  // with a limit smaller than each file (so they are transcoded one
+  // at a time)
+  const size_t limits[] = { 0, fileMemory[0]+fileMemory[1], 1 };
+  for (size_t maxMemory : limits) {
+    BatchTranscoder transcoder(2, maxMemory);
+    const std::vector<BatchTranscoder::Result> results = transcoder.run(jobs);
+    EXPECT(results.size() == 2);
+
+    for (int i=0; i<2; ++i) {
+      const std::vector<uint8_t> input = read_file(inputs[i]);
+      const std::vector<uint8_t> output = read_file(outputs[i]);
+      EXPECT(results[i].ok);
+      EXPECT(results[i].frames == anims[i].frames());
+      EXPECT(results[i].inputBytes == input.size());
+      EXPECT(results[i].outputBytes == output.size());
+      EXPECT(decode_matches(anims[i], output));
+    }
+
+    if (maxMemory == 1)
+      EXPECT(transcoder.peakMemory() == std::max(fileMemory[0], fileMemory[1]));
+    else
+      EXPECT(transcoder.peakMemory() <= fileMemory[0]+fileMemory[1]);
+  }
+
+  // Missing input file
+  BatchTranscoder transcoder;
+  BatchTranscoder::Job missing;
+  missing.input = "flic-tests-batch-missing.flc";
+  missing.output = "flic-tests-batch-missing.out.flc";
+  const auto results = transcoder.run({ missing });
+  EXPECT(results.size() == 1 && !results[0].ok);
+
+  for (int i=0; i<2; ++i) {
+    std::remove(inputs[i]);
+    std::remove(outputs[i]);
+  }
+}
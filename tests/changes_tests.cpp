@@ -0,0 +1,206 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <algorithm>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Frames encoded with BRUN, LC, DELTA and BLACK chunks, and some
+// palette changes
+Animation mixed_changes(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width+height);
+  std::vector<uint8_t> pixels(size_t(width)*height, 0);
+  Colormap colormap = gray_colormap();
+  for (int f=0; f<frames; ++f) {
+    switch (f % 6) {
+      case 0:                   // Runs (BRUN)
+        for (size_t i=0; i<pixels.size(); ) {
+          const int n = 1 + rnd.next(6);
+          const uint8_t color = uint8_t(rnd.next());
+          for (int k=0; k<n && i<pixels.size(); ++k)
+            pixels[i++] = color;
+        }
+        break;
+      case 1:                   // Isolated pixels
+      case 4:
+        for (int k=0; k<10; ++k)
+          pixels[rnd.next(width*height)] = uint8_t(rnd.next());
+        break;
+      case 2:                   // Two-pixel patterns (DELTA)
+        for (int y=1; y<height; y+=3)
+          for (int x=width/3; x<width-2; ++x)
+            pixels[y*width + x] = uint8_t((x & 1) ? f: f+y);
+        break;
+      case 3:                   // Black frame
+        std::fill(pixels.begin(), pixels.end(), 0);
+        break;
+      case 5:                   // A sprite (LC) and palette changes
+        for (int y=0; y<6; ++y)
+          for (int x=0; x<7; ++x)
+            pixels[((y+f) % height)*width + (x+f*2) % width] = uint8_t(f);
+        colormap[0] = Color(uint8_t(f), 0, 0);
+        break;
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+// Returns true if all pixels that are different between "prev" and
+// "pixels" (in rows [y0, y1)) are in the reported changes
+bool changes_cover(const FrameChanges& changes, int width,
+                   const std::vector<uint8_t>& prev,
+                   const std::vector<uint8_t>& pixels,
+                   int y0, int y1)
+{
+  if (int(changes.rows.size()) < y1)
+    return false;
+
+  for (int y=y0; y<y1; ++y) {
+    const Span& span = changes.rows[y];
+    for (int x=0; x<width; ++x) {
+      if (prev[y*width + x] != pixels[y*width + x] &&
+          (x < span.x0 || x >= span.x1 ||
+           y < changes.bounds.y || y >= changes.bounds.y+changes.bounds.h ||
+           x < changes.bounds.x || x >= changes.bounds.x+changes.bounds.w))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool all_changed(const FrameChanges& changes, int width, int y0, int y1)
+{
+  for (int y=y0; y<y1; ++y) {
+    if (changes.rows[y].x0 != 0 || changes.rows[y].x1 != width)
+      return false;
+  }
+  return changes.colormapChanged;
+}
+
+} // anonymous namespace
+
+TEST(changes_cover_changed_pixels)
+{
+  const Animation anim = mixed_changes(67, 45, 36);
+  const std::vector<uint8_t> data = encode(anim);
+
+  // Frames with a color chunk, and all chunk types are tested
+  const std::vector<FrameHeader> frameHeaders = walk_frames(data);
+  std::vector<bool> colorChunk;
+  for (const FrameHeader& frame : frameHeaders) {
+    bool color = false;
+    for (const ChunkHeader& chunk : frame.chunks)
+      color |= (chunk.type == FLI_COLOR_256_CHUNK);
+    colorChunk.push_back(color);
+  }
+  EXPECT(count_chunks(data, FLI_BRUN_CHUNK) > 0);
+  EXPECT(count_chunks(data, FLI_LC_CHUNK) > 0);
+  EXPECT(count_chunks(data, FLI_DELTA_CHUNK) > 0);
+  EXPECT(count_chunks(data, FLI_BLACK_CHUNK) > 0);
+
+  MemoryFileInterface file(data.data(), data.size());
+  Decoder decoder(&file);
+  decoder.setTrackChanges(true);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height, 0);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = anim.width;
+
+  for (int i=0; i<anim.frames(); ++i) {
+    const std::vector<uint8_t> prev = pixels;
+    EXPECT(decoder.readFrame(frame));
+    EXPECT(pixels == anim.pixels[i]);
+
+    const FrameChanges& changes = decoder.changes();
+    EXPECT(changes_cover(changes, anim.width, prev, pixels, 0, anim.height));
+    EXPECT(changes.colormapChanged == colorChunk[i]);
+  }
+
+  // After seekFrame() everything changes, then the next frames report
+  // their own changes
+  const int seeks[] = { 20, 7, 31 };
+  for (int i : seeks) {
+    EXPECT(decoder.seekFrame(i, frame));
+    EXPECT(pixels == anim.pixels[i]);
+    EXPECT(all_changed(decoder.changes(), anim.width, 0, anim.height));
+
+    for (int j=i+1; j<i+4 && j<anim.frames(); ++j) {
+      const std::vector<uint8_t> prev = pixels;
+      EXPECT(decoder.readFrame(frame));
+      EXPECT(pixels == anim.pixels[j]);
+      EXPECT(changes_cover(decoder.changes(), anim.width, prev, pixels, 0, anim.height));
+      EXPECT(decoder.changes().colormapChanged == colorChunk[j]);
+    }
+  }
+}
+
+// With a region of interest, the changes inside the region are
+// reported in the same way
+TEST(changes_with_region_of_interest)
+{
+  const Animation anim = mixed_changes(64, 48, 30);
+  const std::vector<uint8_t> data = encode(anim);
+  const std::vector<FrameHeader> frameHeaders = walk_frames(data);
+
+  MemoryFileInterface file(data.data(), data.size());
+  Decoder decoder(&file);
+  decoder.setTrackChanges(true);
+  decoder.setRegionOfInterest(Rect(0, 10, anim.width, 20));
+  Header header;
+  EXPECT(decoder.readHeader(header));
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height, 0);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = anim.width;
+
+  // Only rows [10, 30) are compared
+  auto roi_pixels = [&anim](const std::vector<uint8_t>& p) {
+    std::vector<uint8_t> result(p.size(), 0);
+    std::copy(p.begin() + 10*anim.width, p.begin() + 30*anim.width,
+              result.begin() + 10*anim.width);
+    return result;
+  };
+
+  auto read_next = [&](int i) {
+    const std::vector<uint8_t> prev = pixels;
+    EXPECT(decoder.readFrame(frame));
+    EXPECT(roi_pixels(pixels) == roi_pixels(anim.pixels[i]));
+    EXPECT(changes_cover(decoder.changes(), anim.width, prev, pixels, 10, 30));
+
+    bool color = false;
+    for (const ChunkHeader& chunk : frameHeaders[i].chunks)
+      color |= (chunk.type == FLI_COLOR_256_CHUNK);
+    EXPECT(decoder.changes().colormapChanged == color);
+  };
+
+  for (int i=0; i<anim.frames(); ++i)
+    read_next(i);
+
+  const int seeks[] = { 13, 4, 25 };
+  for (int i : seeks) {
+    EXPECT(decoder.seekFrame(i, frame));
+    EXPECT(roi_pixels(pixels) == roi_pixels(anim.pixels[i]));
+    EXPECT(all_changed(decoder.changes(), anim.width, 10, 30));
+
+    for (int j=i+1; j<i+4; ++j)
+      read_next(j);
+  }
+}
@@ -0,0 +1,133 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <algorithm>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Few isolated pixels change in each frame (byte packets)
+Animation sparse_pixels(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width*height);
+  std::vector<uint8_t> pixels(size_t(width)*height, 1);
+  for (int f=0; f<frames; ++f) {
+    for (int k=0; k<1+width*height/200; ++k)
+      pixels[rnd.next(width*height)] = uint8_t(rnd.next());
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  return anim;
+}
+
+// Long runs of two-pixel patterns change in the middle of each line
+// (word packets)
+Animation word_patterns(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  std::vector<uint8_t> pixels(size_t(width)*height, 0);
+  for (int f=0; f<frames; ++f) {
+    for (int y=0; y<height; y+=2) {
+      for (int x=width/4; x<width*3/4; ++x)
+        pixels[y*width + x] = uint8_t((x & 1) ? f: f+y);
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  return anim;
+}
+
+// A small sprite moving over a big static canvas
+Animation sprite_on_canvas(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  std::vector<uint8_t> background(size_t(width)*height);
+  for (size_t i=0; i<background.size(); ++i)
+    background[i] = uint8_t(i*7 / 13);
+  for (int f=0; f<frames; ++f) {
+    std::vector<uint8_t> pixels = background;
+    for (int y=0; y<24 && y<height; ++y)
+      for (int x=0; x<24 && x<width; ++x)
+        pixels[((y+f*2) % height)*width + (x+f*3) % width] = uint8_t(200 + (x ^ y) % 50);
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+TEST(delta_round_trips)
+{
+  const int sizes[][2] = { { 640, 480 }, { 33, 17 }, { 1, 1 }, { 5, 300 }, { 1921, 40 } };
+  int lcChunks = 0;
+  int deltaChunks = 0;
+
+  for (const auto& size : sizes) {
+    const Animation anims[] = {
+      sparse_pixels(size[0], size[1], 8),
+      word_patterns(size[0], size[1], 8),
+      sprite_on_canvas(size[0], size[1], 8),
+    };
+    for (const Animation& anim : anims) {
+      const std::vector<uint8_t> data = encode(anim);
+      EXPECT(decode_matches(anim, data));
+      lcChunks += count_chunks(data, FLI_LC_CHUNK);
+      deltaChunks += count_chunks(data, FLI_DELTA_CHUNK);
+    }
+  }
+
+  // Both delta encoders must be tested
+  EXPECT(lcChunks > 0);
+  EXPECT(deltaChunks > 0);
+}
+
+// A line with changes spread over more than 255*127 pixels cannot be
+// encoded with LC (255 packets per line at most)
+TEST(delta_very_wide_lines)
+{
+  Animation anim;
+  anim.width = 40000;
+  anim.height = 2;
+  Random rnd(1);
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+  for (int f=0; f<3; ++f) {
+    for (size_t i=0; i<pixels.size(); i+=(f == 0 ? 1: 3))
+      pixels[i] = uint8_t(rnd.next());
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  EXPECT(decode_matches(anim, encode(anim)));
+
+  // Only one line (which is not used to estimate the chunk sizes)
+  // is too wide for LC, so LC must be discarded after encoding it
+  anim = Animation();
+  anim.width = 40000;
+  anim.height = 100;
+  pixels.assign(size_t(anim.width)*anim.height, 0);
+  for (int f=0; f<3; ++f) {
+    for (int y=0; y<anim.height; ++y)
+      pixels[y*anim.width + f] = uint8_t(f+1);
+    if (f > 0) {
+      for (int x=0; x<anim.width; x+=3)
+        pixels[anim.width + x] = uint8_t(rnd.next());
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  EXPECT(decode_matches(anim, encode(anim)));
+}
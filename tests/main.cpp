@@ -0,0 +1,48 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <cstring>
+
+namespace flic_tests {
+
+std::vector<TestCase>& test_cases()
+{
+  static std::vector<TestCase> cases;
+  return cases;
+}
+
+int& test_failures()
+{
+  static int failures = 0;
+  return failures;
+}
+
+} // namespace flic_tests
+
+// Runs all tests, or only the ones which name contains argv[1]
+int main(int argc, char* argv[])
+{
+  using namespace flic_tests;
+
+  int failedTests = 0;
+  for (const TestCase& test : test_cases()) {
+    if (argc > 1 && !std::strstr(test.name, argv[1]))
+      continue;
+
+    const int failures = test_failures();
+    test.func();
+    if (test_failures() > failures) {
+      std::printf("FAILED %s\n", test.name);
+      ++failedTests;
+    }
+    else
+      std::printf("OK %s\n", test.name);
+  }
+
+  return (failedTests > 0 ? 1: 0);
+}
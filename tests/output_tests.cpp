@@ -0,0 +1,137 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <cstring>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// The pixels change only in some frames, the palette is rotated in
+// the other ones
+Animation palette_cycling(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width*height);
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  for (int y=0; y<height; ++y)
+    for (int x=0; x<width; ++x)
+      pixels[y*width + x] = uint8_t(x+y);
+  Colormap colormap;
+  for (int i=0; i<Colormap::SIZE; ++i)
+    colormap[i] = Color(uint8_t(i), uint8_t(i*3), uint8_t(255-i));
+
+  for (int f=0; f<frames; ++f) {
+    if (f % 5 == 4) {
+      for (int k=0; k<20; ++k)
+        pixels[rnd.next(width*height)] = uint8_t(rnd.next());
+    }
+    else if (f > 0) {
+      const Color first = colormap[0];
+      for (int i=0; i<15; ++i)
+        colormap[i] = colormap[i+1];
+      colormap[15] = first;
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+// Returns true if each pixel in "output" is the color of the
+// indexed "pixels" in the given format
+bool output_matches(const std::vector<uint8_t>& output, PixelFormat format,
+                    const std::vector<uint8_t>& pixels,
+                    const Colormap& colormap)
+{
+  for (size_t i=0; i<pixels.size(); ++i) {
+    const Color c = colormap[pixels[i]];
+    if (format == PixelFormat::RGB565) {
+      uint16_t value;
+      std::memcpy(&value, &output[i*2], 2);
+      if (value != (((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3)))
+        return false;
+    }
+    else {
+      const uint8_t* rgba = &output[i*4];
+      if (rgba[0] != (format == PixelFormat::RGBA8 ? c.r: c.b) ||
+          rgba[1] != c.g ||
+          rgba[2] != (format == PixelFormat::RGBA8 ? c.b: c.r) ||
+          rgba[3] != 255)
+        return false;
+    }
+  }
+  return true;
+}
+
+bool no_pixel_changes(const FrameChanges& changes)
+{
+  for (const Span& span : changes.rows) {
+    if (span.x0 < span.x1)
+      return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+TEST(output_palette_cycling)
+{
+  const Animation anim = palette_cycling(61, 37, 20);
+  const std::vector<uint8_t> data = encode(anim);
+  const PixelFormat formats[] = {
+    PixelFormat::RGBA8,
+    PixelFormat::BGRA8,
+    PixelFormat::RGB565,
+  };
+
+  for (PixelFormat format : formats) {
+    const int bpp = (format == PixelFormat::RGB565 ? 2: 4);
+    MemoryFileInterface file(data.data(), data.size());
+    Decoder decoder(&file);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+
+    std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+    std::vector<uint8_t> output(pixels.size()*bpp);
+    Frame frame;
+    frame.pixels = pixels.data();
+    frame.rowstride = anim.width;
+    decoder.setOutput(output.data(), anim.width*bpp, format);
+
+    for (int i=0; i<anim.frames(); ++i) {
+      EXPECT(decoder.readFrame(frame));
+      EXPECT(pixels == anim.pixels[i]);
+      EXPECT(output_matches(output, format, pixels, frame.colormap));
+
+      // Only the palette changes in these frames
+      if (i > 0 && i % 5 != 4) {
+        EXPECT(decoder.changes().colormapChanged);
+        EXPECT(no_pixel_changes(decoder.changes()));
+      }
+    }
+
+    const int seeks[] = { 13, 2, 19, 0 };
+    for (int i : seeks) {
+      EXPECT(decoder.seekFrame(i, frame));
+      EXPECT(output_matches(output, format, pixels, frame.colormap));
+    }
+
+    // A new output buffer is converted completely, even if the next
+    // frame doesn't change the palette
+    std::vector<uint8_t> output2(output.size(), 0);
+    EXPECT(decoder.seekFrame(3, frame));
+    decoder.setOutput(output2.data(), anim.width*bpp, format);
+    EXPECT(decoder.readFrame(frame));
+    EXPECT(!decoder.changes().colormapChanged);
+    EXPECT(output_matches(output2, format, pixels, frame.colormap));
+  }
+}
@@ -0,0 +1,61 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+Animation palette_animation(int frames, bool cycling, uint32_t seed)
+{
+  Animation anim;
+  anim.width = 37;
+  anim.height = 21;
+  Random rnd(seed);
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+  for (size_t i=0; i<pixels.size(); ++i)
+    pixels[i] = uint8_t(i);
+
+  const Colormap base = gray_colormap();
+  Colormap colormap = base;
+  for (int f=0; f<frames; ++f) {
+    if (cycling) {
+      // Rotate the whole palette (every entry changes)
+      for (int i=0; i<Colormap::SIZE; ++i)
+        colormap[i] = base[(i+f) % Colormap::SIZE];
+    }
+    else if (f > 0) {
+      // Scattered edits, sometimes next to each other or at the ends
+      for (int k=rnd.next(6); k>=0; --k) {
+        const int i = (k == 0 ? 255: rnd.next(256));
+        colormap[i] = Color(uint8_t(rnd.next()), uint8_t(rnd.next()), uint8_t(rnd.next()));
+      }
+      if (f % 3 == 0)
+        colormap[0] = Color(uint8_t(f), 0, 0);
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+TEST(palette_sparse_edits)
+{
+  for (uint32_t seed=1; seed<=20; ++seed) {
+    const Animation anim = palette_animation(12, false, seed);
+    EXPECT(decode_matches(anim, encode(anim)));
+  }
+}
+
+TEST(palette_cycling)
+{
+  const Animation anim = palette_animation(300, true, 0);
+  EXPECT(decode_matches(anim, encode(anim)));
+}
@@ -0,0 +1,113 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Big frames (so they are split in several bands) with a noisy
+// keyframe, runs of mixed lengths, and small changes
+Animation big_frames(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width+height);
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  for (int f=0; f<frames; ++f) {
+    if (f == 0) {
+      for (uint8_t& p : pixels)
+        p = uint8_t(rnd.next());
+    }
+    else if (f == 1) {
+      for (size_t i=0; i<pixels.size(); ) {
+        const int n = 1 + rnd.next(12);
+        const uint8_t color = uint8_t(rnd.next());
+        for (int k=0; k<n && i<pixels.size(); ++k)
+          pixels[i++] = color;
+      }
+    }
+    else {
+      for (int k=0; k<5000; ++k)
+        pixels[rnd.next(width*height)] = uint8_t(rnd.next());
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+TEST(parallel_lines_same_output)
+{
+  const Animation anim = big_frames(1023, 515, 5);
+  const std::vector<uint8_t> serial = encode(anim);
+  EXPECT(decode_matches(anim, serial));
+
+  for (int threads=2; threads<=5; ++threads) {
+    std::vector<uint8_t> data;
+    MemoryFileInterface file(&data);
+    {
+      Encoder encoder(&file);
+      encoder.setThreads(threads);
+      encoder.setParallelLines(true);
+      encode(anim, encoder);
+    }
+    EXPECT(data == serial);
+  }
+}
+
+// writeFrames() gives the same output as writeFrame() calls
+TEST(parallel_frames_same_output)
+{
+  // With palette changes in some frames
+  Animation anim = big_frames(160, 97, 23);
+  for (int i=3; i<anim.frames(); i+=4)
+    for (int j=i; j<anim.frames(); ++j)
+      anim.colormaps[j][i] = Color(255, uint8_t(i), 0);
+  const std::vector<uint8_t> serial = encode(anim);
+
+  std::vector<Frame> frames;
+  for (int i=0; i<anim.frames(); ++i)
+    frames.push_back(make_frame(anim, i));
+
+  const int threads[] = { 1, 2, 8 };
+  const std::vector<int> splits[] = {
+    { 23 },                     // All frames in one batch
+    { 1, 1, 1, 20 },
+    { 5, 2, 9, 1, 6 },
+    { 3, 3, 3, 3, 3, 3, 3, 2 },
+  };
+  for (int n : threads) {
+    for (const std::vector<int>& split : splits) {
+      std::vector<uint8_t> data;
+      MemoryFileInterface file(&data);
+      {
+        Encoder encoder(&file);
+        encoder.setThreads(n);
+
+        Header header;
+        header.frames = anim.frames();
+        header.width = anim.width;
+        header.height = anim.height;
+        header.speed = 50;
+        encoder.writeHeader(header);
+
+        int i = 0;
+        for (int batch : split) {
+          encoder.writeFrames(&frames[i], batch);
+          i += batch;
+        }
+        encoder.writeRingFrame(frames[0]);
+      }
+      EXPECT(data == serial);
+    }
+  }
+}
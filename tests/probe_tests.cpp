@@ -0,0 +1,149 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Frames with all kind of chunks: noise (COPY), black frames, small
+// changes (LC/DELTA), runs (BRUN) and palette changes
+Animation mixed_chunks(int frames)
+{
+  Animation anim;
+  anim.width = 320;
+  anim.height = 200;
+  Random rnd(3);
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+  Colormap colormap = gray_colormap();
+  for (int f=0; f<frames; ++f) {
+    switch (f % 5) {
+      case 0:
+        for (uint8_t& p : pixels)
+          p = uint8_t(rnd.next());
+        break;
+      case 1:
+        std::fill(pixels.begin(), pixels.end(), 0);
+        break;
+      case 2:
+      case 3:
+        for (int k=0; k<100; ++k)
+          pixels[rnd.next(int(pixels.size()))] = uint8_t(rnd.next());
+        break;
+      case 4:
+        for (size_t i=0; i<pixels.size(); ) {
+          const int n = 1 + rnd.next(20);
+          const uint8_t color = uint8_t(rnd.next());
+          for (int k=0; k<n && i<pixels.size(); ++k)
+            pixels[i++] = color;
+        }
+        colormap[0] = Color(uint8_t(f), 0, 0);
+        break;
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+// probe() returns the frames and chunks that the Encoder wrote
+TEST(probe_frames_and_chunks)
+{
+  const Animation anim = mixed_chunks(15);
+  const std::vector<uint8_t> data = encode(anim);
+  const std::vector<FrameHeader> expected = walk_frames(data);
+  EXPECT(int(expected.size()) == anim.frames()+1); // With ring frame
+
+  MemoryFileInterface file(data.data(), data.size());
+  Decoder decoder(&file);
+  Header header;
+  std::vector<FrameInfo> frames;
+  EXPECT(decoder.probe(header, frames));
+  EXPECT(header.frames == anim.frames());
+  EXPECT(header.width == anim.width);
+  EXPECT(header.height == anim.height);
+  EXPECT(frames.size() == expected.size());
+  if (frames.size() != expected.size())
+    return;
+
+  int types[5] = { 0 };
+  for (size_t i=0; i<frames.size(); ++i) {
+    const FrameInfo& frame = frames[i];
+    EXPECT(frame.offset == expected[i].offset);
+    EXPECT(frame.size == expected[i].size);
+    EXPECT(frame.chunks.size() == expected[i].chunks.size());
+    if (frame.chunks.size() != expected[i].chunks.size())
+      continue;
+
+    bool keyframe = (i == 0);
+    bool colorChunk = false;
+    for (size_t j=0; j<frame.chunks.size(); ++j) {
+      const ChunkInfo& chunk = frame.chunks[j];
+      EXPECT(chunk.offset == expected[i].chunks[j].offset);
+      EXPECT(chunk.size == expected[i].chunks[j].size);
+      EXPECT(chunk.type == expected[i].chunks[j].type);
+      switch (chunk.type) {
+        case FLI_COLOR_256_CHUNK: colorChunk = true; break;
+        case FLI_BLACK_CHUNK:     keyframe = true; ++types[0]; break;
+        case FLI_BRUN_CHUNK:      keyframe = true; ++types[1]; break;
+        case FLI_COPY_CHUNK:      keyframe = true; ++types[2]; break;
+        case FLI_LC_CHUNK:        ++types[3]; break;
+        case FLI_DELTA_CHUNK:     ++types[4]; break;
+      }
+    }
+    EXPECT(frame.keyframe == keyframe);
+    EXPECT(frame.colorChunk == colorChunk);
+  }
+
+  // All kind of chunks were tested
+  for (int n : types)
+    EXPECT(n > 0);
+}
+
+// probe() can be called in the middle of the decoding
+TEST(probe_keeps_decode_position)
+{
+  const Animation anim = mixed_chunks(12);
+  const std::vector<uint8_t> data = encode(anim);
+
+  FILE* f = std::tmpfile();
+  std::fwrite(data.data(), 1, data.size(), f);
+  std::fseek(f, 0, SEEK_SET);
+  MemoryFileInterface memFile(data.data(), data.size());
+  StdioFileInterface stdioFile(f);
+  FileInterface* files[] = { &memFile, &stdioFile };
+
+  for (FileInterface* file : files) {
+    Decoder decoder(file);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+
+    std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+    Frame frame;
+    frame.pixels = pixels.data();
+    frame.rowstride = anim.width;
+
+    for (int i=0; i<anim.frames(); ++i) {
+      if (i % 4 == 3) {
+        const size_t pos = file->tell();
+        std::vector<FrameInfo> frames;
+        EXPECT(decoder.probe(header, frames));
+        EXPECT(file->tell() == pos);
+      }
+      EXPECT(decoder.readFrame(frame));
+      EXPECT(pixels == anim.pixels[i]);
+      EXPECT(frame.colormap == anim.colormaps[i]);
+    }
+  }
+  std::fclose(f);
+}
@@ -0,0 +1,100 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <cstring>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// A sprite moving over all rows, so each frame changes different rows
+Animation moving_rows(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(width);
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  for (uint8_t& p : pixels)
+    p = uint8_t(rnd.next(3));
+  for (int f=0; f<frames; ++f) {
+    for (int y=0; y<8; ++y)
+      for (int x=0; x<width/2; ++x)
+        pixels[((y+f*5) % height)*width + (x+f) % width] = uint8_t(rnd.next());
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  return anim;
+}
+
+bool rows_match(const Animation& anim, int i, const std::vector<uint8_t>& pixels,
+                int y0, int y1)
+{
+  return (std::memcmp(pixels.data() + y0*anim.width,
+                      anim.pixels[i].data() + y0*anim.width,
+                      size_t(y1-y0)*anim.width) == 0);
+}
+
+} // anonymous namespace
+
+TEST(roi_sequential_and_seek)
+{
+  const Animation anim = moving_rows(320, 200, 12);
+  const std::vector<uint8_t> data = encode(anim);
+  MemoryFileInterface file(data.data(), data.size());
+  Decoder decoder(&file);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height, 0);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = anim.width;
+
+  decoder.setRegionOfInterest(Rect(0, 60, anim.width, 50));
+  for (int i=0; i<anim.frames(); ++i) {
+    EXPECT(decoder.readFrame(frame));
+    EXPECT(rows_match(anim, i, pixels, 60, 110));
+  }
+
+  // A bigger region must be decoded again by seekFrame()
+  decoder.setRegionOfInterest(Rect(0, 20, anim.width, 150));
+  EXPECT(decoder.seekFrame(7, frame));
+  EXPECT(rows_match(anim, 7, pixels, 20, 170));
+
+  decoder.setRegionOfInterest(Rect());
+  EXPECT(decoder.seekFrame(9, frame));
+  EXPECT(rows_match(anim, 9, pixels, 0, anim.height));
+}
+
+// probe() must not change which rows of the current frame are valid
+TEST(roi_probe_keeps_valid_rows)
+{
+  const Animation anim = moving_rows(64, 48, 12);
+  const std::vector<uint8_t> data = encode(anim);
+  MemoryFileInterface file(data.data(), data.size());
+  Decoder decoder(&file);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height, 0);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = anim.width;
+
+  decoder.setRegionOfInterest(Rect(0, 0, anim.width, 10));
+  for (int i=0; i<6; ++i)
+    EXPECT(decoder.readFrame(frame));
+
+  decoder.setRegionOfInterest(Rect());
+  std::vector<FrameInfo> frames;
+  EXPECT(decoder.probe(header, frames));
+  EXPECT(decoder.seekFrame(7, frame));
+  EXPECT(rows_match(anim, 7, pixels, 0, anim.height));
+}
@@ -0,0 +1,80 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Encoded size of each scenario. If the encoder produces a bigger
+// file the test fails (a compression regression). If it produces a
+// smaller one, the baseline should be updated.
+struct Baseline {
+  Scenario scenario;
+  int width, height;
+  size_t size;
+} baselines[] = {
+  { Noise,          320, 200, 449060 },
+  { Flat,           320, 200,   8060 },
+  { Sprite,         320, 200,   6612 },
+  { PaletteCycling, 320, 200,  69692 },
+  { SceneCuts,      320, 200, 114930 },
+  { Runs,           320, 200, 203200 },
+  { BlackFrames,    320, 200, 154068 },
+  { Noise,           33,  17,   5232 },
+  { Flat,            33,  17,   1320 },
+  { Sprite,          33,  17,   4494 },
+  { PaletteCycling,  33,  17,   6288 },
+  { SceneCuts,       33,  17,   2868 },
+  { Runs,            33,  17,   3224 },
+  { BlackFrames,     33,  17,   2598 },
+  { Noise,          641,  97, 441052 },
+  { Flat,           641,  97,   7370 },
+  { Sprite,         641,  97,   6434 },
+  { PaletteCycling, 641,  97,  68548 },
+  { SceneCuts,      641,  97, 111480 },
+  { Runs,           641,  97, 195656 },
+  { BlackFrames,    641,  97, 147464 },
+  { Sprite,           1,   1,   1080 },
+  { Runs,             5, 300,  11842 },
+};
+
+} // anonymous namespace
+
+TEST(round_trip_scenarios)
+{
+  for (const Baseline& baseline : baselines) {
+    const Animation anim = make_animation(baseline.scenario,
+                                          baseline.width, baseline.height, 6);
+    const std::vector<uint8_t> data = encode(anim);
+    const char* name = scenario_name(baseline.scenario);
+
+    if (!decode_matches(anim, data)) {
+      std::printf("  %s %dx%d doesn't round-trip\n", name, anim.width, anim.height);
+      EXPECT(false);
+    }
+
+    if (data.size() != baseline.size) {
+      std::printf("  %s %dx%d: %zu bytes (baseline %zu)\n",
+                  name, anim.width, anim.height, data.size(), baseline.size);
+    }
+    EXPECT(data.size() <= baseline.size);
+  }
+}
+
+// The decoder supports COPY chunks only in 320x200 animations
+TEST(round_trip_copy_chunks)
+{
+  const Animation anim = make_animation(Noise, 320, 200, 4);
+  const std::vector<uint8_t> data = encode(anim);
+  EXPECT(decode_matches(anim, data));
+  EXPECT(count_chunks(data, FLI_COPY_CHUNK) > 0);
+}
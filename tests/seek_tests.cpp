@@ -0,0 +1,252 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <cstdio>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Creates FLC files chunk by chunk (e.g. with chunks that our
+// Encoder doesn't generate)
+class FlcWriter {
+public:
+  std::vector<uint8_t> data;
+
+  FlcWriter(int width, int height, int frames) : data(128, 0) {
+    put16(4, FLC_MAGIC_NUMBER);
+    put16(6, frames);
+    put16(8, width);
+    put16(10, height);
+    put16(12, 8);               // Color depth
+  }
+
+  void beginFrame() {
+    m_frameStart = data.size();
+    m_chunks = 0;
+    data.resize(data.size()+16, 0);
+    put16(m_frameStart+4, FLI_FRAME_MAGIC_NUMBER);
+  }
+
+  void endFrame() {
+    put32(m_frameStart, uint32_t(data.size() - m_frameStart));
+    put16(m_frameStart+6, m_chunks);
+    put32(0, uint32_t(data.size()));
+  }
+
+  // Color chunk with one packet to change "colors" starting from "first"
+  void colorChunk(int first, const std::vector<Color>& colors) {
+    const size_t start = beginChunk();
+    add16(1);                   // Packets
+    data.push_back(uint8_t(first));
+    data.push_back(uint8_t(colors.size()));
+    for (const Color& c : colors) {
+      data.push_back(c.r);
+      data.push_back(c.g);
+      data.push_back(c.b);
+    }
+    if ((data.size() - start) & 1)
+      data.push_back(0);
+    endChunk(start, FLI_COLOR_256_CHUNK);
+  }
+
+  void blackChunk() {
+    endChunk(beginChunk(), FLI_BLACK_CHUNK);
+  }
+
+private:
+  size_t beginChunk() {
+    const size_t start = data.size();
+    data.resize(start+6, 0);
+    ++m_chunks;
+    return start;
+  }
+
+  void endChunk(size_t start, int type) {
+    put32(start, uint32_t(data.size() - start));
+    put16(start+4, type);
+  }
+
+  void add16(int value) {
+    data.push_back(uint8_t(value));
+    data.push_back(uint8_t(value >> 8));
+  }
+
+  void put16(size_t pos, int value) {
+    data[pos] = uint8_t(value);
+    data[pos+1] = uint8_t(value >> 8);
+  }
+
+  void put32(size_t pos, uint32_t value) {
+    put16(pos, int(value & 0xffff));
+    put16(pos+2, int(value >> 16));
+  }
+
+  size_t m_frameStart = 0;
+  int m_chunks = 0;
+};
+
+} // anonymous namespace
+
+// All FileInterface implementations can be read again after a seek()
+TEST(seek_clears_read_errors)
+{
+  const uint8_t bytes[] = { 1, 2, 3 };
+  const char* filename = "flic-tests-seek.tmp";
+  FILE* f = std::fopen(filename, "wb");
+  EXPECT(f != nullptr);
+  if (!f)
+    return;
+  std::fwrite(bytes, 1, sizeof(bytes), f);
+  std::fclose(f);
+
+  f = std::fopen(filename, "rb");
+  {
+    MemoryFileInterface memFile(bytes, sizeof(bytes));
+    MappedFileInterface mappedFile(filename);
+    StdioFileInterface stdioFile(f);
+    FileInterface* files[] = { &memFile, &mappedFile, &stdioFile };
+
+    for (FileInterface* file : files) {
+      uint8_t buf[4];
+      file->seek(1);
+      file->read(buf, 4);
+      EXPECT(!file->ok());
+
+      file->seek(2);
+      EXPECT(file->ok());
+      EXPECT(file->read8() == 3);
+      EXPECT(file->ok());
+    }
+  }
+  std::fclose(f);
+  std::remove(filename);
+
+  // A file that cannot be mapped is never ok()
+  MappedFileInterface missing("flic-tests-missing.tmp");
+  EXPECT(!missing.ok());
+  missing.seek(0);
+  EXPECT(!missing.ok());
+}
+
+// The first color chunk (from other encoders) can change only some
+// colors, so seeking backwards must restart from a black palette
+TEST(seek_backwards_palette)
+{
+  const int nframes = 5;
+  FlcWriter flc(8, 8, nframes);
+  flc.beginFrame();             // Frame 0: 4 colors (partial palette)
+  flc.colorChunk(0, { Color(10, 20, 30), Color(40, 50, 60),
+                      Color(70, 80, 90), Color(1, 2, 3) });
+  flc.blackChunk();
+  flc.endFrame();
+  flc.beginFrame();             // Frame 1: color 100 changes
+  flc.colorChunk(100, { Color(200, 0, 0) });
+  flc.endFrame();
+  flc.beginFrame();             // Frame 2: color 101 changes
+  flc.colorChunk(101, { Color(0, 200, 0) });
+  flc.endFrame();
+  flc.beginFrame();             // Frame 3: keyframe, same palette
+  flc.blackChunk();
+  flc.endFrame();
+  flc.beginFrame();             // Frame 4: color 0 changes
+  flc.colorChunk(0, { Color(255, 255, 255) });
+  flc.endFrame();
+
+  std::vector<uint8_t> pixels(8*8);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = 8;
+
+  // Palettes decoding frames sequentially
+  std::vector<Colormap> colormaps;
+  {
+    MemoryFileInterface file(flc.data.data(), flc.data.size());
+    Decoder decoder(&file);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+    for (int i=0; i<nframes; ++i) {
+      EXPECT(decoder.readFrame(frame));
+      colormaps.push_back(frame.colormap);
+    }
+  }
+  EXPECT(colormaps[0][100] == Color(0, 0, 0));
+  EXPECT(colormaps[3][100] == Color(200, 0, 0));
+
+  MemoryFileInterface file(flc.data.data(), flc.data.size());
+  Decoder decoder(&file);
+  Header header;
+  EXPECT(decoder.readHeader(header));
+  frame.colormap = Colormap();
+
+  const int seeks[] = { 4, 0, 4, 3, 2, 4, 1, 3, 0 };
+  for (int i : seeks) {
+    EXPECT(decoder.seekFrame(i, frame));
+    EXPECT(frame.colormap == colormaps[i]);
+  }
+}
+
+// Random seeks with the snapshot cache (with and without a memory
+// limit) give the same frames as the sequential decoding
+TEST(seek_snapshot_cache)
+{
+  // Only the first frame is a keyframe
+  Animation anim;
+  anim.width = 48;
+  anim.height = 32;
+  Random rnd(12);
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height, 0);
+  Colormap colormap = gray_colormap();
+  for (int f=0; f<120; ++f) {
+    for (int k=0; k<20; ++k)
+      pixels[rnd.next(int(pixels.size()))] = uint8_t(rnd.next());
+    if (f % 7 == 0)
+      colormap[0] = Color(uint8_t(f), 1, 2);
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  const std::vector<uint8_t> data = encode(anim);
+  const size_t frameSize = pixels.size();
+
+  struct {
+    int interval;
+    size_t maxBytes;
+  } caches[] = {
+    { 10, 0 },                  // No limit
+    { 7, 3*frameSize },         // Re-uses the least recently used
+    { 1, 2*frameSize },
+    { 5, frameSize-1 },         // No snapshot fits
+  };
+
+  for (const auto& cache : caches) {
+    MemoryFileInterface file(data.data(), data.size());
+    Decoder decoder(&file);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+    decoder.setSnapshotCache(cache.interval, cache.maxBytes);
+
+    Frame frame;
+    frame.pixels = pixels.data();
+    frame.rowstride = anim.width;
+
+    for (int k=0; k<200; ++k) {
+      const int i = rnd.next(anim.frames());
+      EXPECT(decoder.seekFrame(i, frame));
+      EXPECT(pixels == anim.pixels[i]);
+      EXPECT(frame.colormap == anim.colormaps[i]);
+
+      // Continue with the next frame
+      if (k % 5 == 0 && i+1 < anim.frames()) {
+        EXPECT(decoder.readFrame(frame));
+        EXPECT(pixels == anim.pixels[i+1]);
+        EXPECT(frame.colormap == anim.colormaps[i+1]);
+      }
+    }
+  }
+}
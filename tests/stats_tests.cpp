@@ -0,0 +1,113 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+// These tests need a library compiled with the FLIC_STATS option
+#if FLIC_STATS
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Keyframes each 8 frames, and palette changes in the other frames
+Animation palette_and_keyframes(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  Random rnd(frames);
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  Colormap colormap = gray_colormap();
+  for (int f=0; f<frames; ++f) {
+    if (f % 8 == 0) {
+      for (uint8_t& p : pixels)
+        p = uint8_t(rnd.next());
+    }
+    else {
+      pixels[rnd.next(width*height)] = uint8_t(f);
+      colormap[rnd.next(256)] = Color(f, f, f);
+    }
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(colormap);
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+TEST(stats_counted_frames)
+{
+  const Animation anim = palette_and_keyframes(64, 40, 30);
+  std::vector<uint8_t> data;
+  {
+    MemoryFileInterface file(&data);
+    Encoder encoder(&file);
+    encode(anim, encoder);
+    EXPECT(encoder.stats().frames == uint64_t(anim.frames()+1)); // With ring frame
+  }
+
+  std::vector<FrameInfo> frames;
+  {
+    MemoryFileInterface file(data.data(), data.size());
+    Decoder decoder(&file);
+    Header header;
+    EXPECT(decoder.probe(header, frames));
+  }
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = anim.width;
+
+  // Sequential decoding (without the ring frame)
+  {
+    MemoryFileInterface file(data.data(), data.size());
+    Decoder decoder(&file);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+    for (int i=0; i<anim.frames(); ++i)
+      EXPECT(decoder.readFrame(frame));
+
+    const Stats& stats = decoder.stats();
+    EXPECT(stats.frames == uint64_t(anim.frames()));
+
+    uint64_t chunks[Stats::kChunkTypes] = { 0 };
+    uint64_t frameBytes = 0;
+    for (int i=0; i<anim.frames(); ++i) {
+      frameBytes += frames[i].size;
+      for (const ChunkInfo& chunk : frames[i].chunks)
+        ++chunks[chunk.type];
+    }
+    EXPECT(stats.frameBytes == frameBytes);
+    for (int type=0; type<Stats::kChunkTypes; ++type)
+      EXPECT(stats.chunks[type].count == chunks[type]);
+  }
+
+  // Each seekFrame() returns one frame (the palette of previous
+  // frames and the frames after the keyframe are decoded too)
+  {
+    MemoryFileInterface file(data.data(), data.size());
+    Decoder decoder(&file);
+    Header header;
+    EXPECT(decoder.readHeader(header));
+
+    const int seeks[] = { 29, 3, 20, 7, 15 };
+    for (int i : seeks) {
+      EXPECT(decoder.seekFrame(i, frame));
+      EXPECT(pixels == anim.pixels[i]);
+    }
+    EXPECT(decoder.stats().frames == 5);
+    EXPECT(decoder.stats().frameBytes > 0);
+
+    decoder.resetStats();
+    EXPECT(decoder.readFrame(frame));
+    EXPECT(decoder.stats().frames == 1);
+  }
+}
+
+#endif // FLIC_STATS
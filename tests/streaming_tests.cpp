@@ -0,0 +1,155 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "test.h"
+
+#include <algorithm>
+
+using namespace flic;
+using namespace flic_tests;
+
+namespace {
+
+// Write-only file (like a pipe or a network socket) which fails the
+// test if the encoder tries to seek or read
+class WriteOnlySink : public FileInterface {
+public:
+  std::vector<uint8_t> data;
+  bool invalidCall = false;
+
+  bool ok() const override { return true; }
+  bool seekable() const override { return false; }
+  size_t tell() override { invalidCall = true; return 0; }
+  void seek(size_t) override { invalidCall = true; }
+  uint8_t read8() override { invalidCall = true; return 0; }
+  void write8(uint8_t value) override { data.push_back(value); }
+  void write(const uint8_t* buf, size_t n) override {
+    data.insert(data.end(), buf, buf+n);
+  }
+};
+
+Animation moving_sprite(int width, int height, int frames)
+{
+  Animation anim;
+  anim.width = width;
+  anim.height = height;
+  std::vector<uint8_t> pixels(size_t(width)*height);
+  for (int f=0; f<frames; ++f) {
+    std::fill(pixels.begin(), pixels.end(), 3);
+    for (int y=0; y<16 && y<height; ++y)
+      for (int x=0; x<16 && x<width; ++x)
+        pixels[((y+f*3) % height)*width + (x+f*5) % width] = uint8_t((x ^ y) + f);
+    anim.pixels.push_back(pixels);
+    anim.colormaps.push_back(gray_colormap());
+  }
+  return anim;
+}
+
+} // anonymous namespace
+
+TEST(streaming_write_only_sink)
+{
+  const Animation anim = moving_sprite(97, 61, 8);
+
+  WriteOnlySink sink;
+  {
+    Encoder encoder(&sink);
+    encode(anim, encoder);
+  }
+  EXPECT(!sink.invalidCall);
+  EXPECT(decode_matches(anim, sink.data));
+
+  // Same output as a seekable file, except the file size field
+  // (which is 0 in streaming mode)
+  std::vector<uint8_t> seekable = encode(anim);
+  EXPECT(sink.data.size() == seekable.size());
+  if (sink.data.size() == seekable.size() && seekable.size() >= 4) {
+    EXPECT(sink.data[0] == 0 && sink.data[1] == 0 &&
+           sink.data[2] == 0 && sink.data[3] == 0);
+    EXPECT(std::equal(sink.data.begin()+4, sink.data.end(), seekable.begin()+4));
+  }
+}
+
+// Files written in one pass have no file size in the header, but the
+// ring frame must be indexed anyway
+TEST(streaming_index_ring_frame)
+{
+  const Animation anim = moving_sprite(64, 48, 8);
+  WriteOnlySink sink;
+  {
+    Encoder encoder(&sink);
+    encode(anim, encoder);
+  }
+
+  // From memory and from a FILE*
+  FILE* f = std::tmpfile();
+  std::fwrite(sink.data.data(), 1, sink.data.size(), f);
+  MemoryFileInterface memFile(sink.data.data(), sink.data.size());
+  StdioFileInterface stdioFile(f);
+  FileInterface* files[] = { &memFile, &stdioFile };
+
+  for (FileInterface* file : files) {
+    file->seek(0);
+    Decoder decoder(file);
+    Header header;
+    std::vector<FrameInfo> frames;
+    EXPECT(decoder.probe(header, frames));
+    EXPECT(int(frames.size()) == anim.frames()+1);
+
+    std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+    Frame frame;
+    frame.pixels = pixels.data();
+    frame.rowstride = anim.width;
+    EXPECT(decoder.readHeader(header));
+    EXPECT(decoder.seekFrame(anim.frames(), frame)); // Ring frame
+    EXPECT(pixels == anim.pixels[0]);
+    EXPECT(decoder.seekFrame(5, frame));
+    EXPECT(pixels == anim.pixels[5]);
+  }
+  std::fclose(f);
+}
+
+// Without ring frame, looking for it must not break the decoding of
+// the other frames
+TEST(streaming_index_without_ring_frame)
+{
+  const Animation anim = moving_sprite(64, 48, 6);
+  WriteOnlySink sink;
+  {
+    Encoder encoder(&sink);
+    Header header;
+    header.frames = anim.frames();
+    header.width = anim.width;
+    header.height = anim.height;
+    header.speed = 50;
+    encoder.writeHeader(header);
+    for (int i=0; i<anim.frames(); ++i)
+      encoder.writeFrame(make_frame(anim, i));
+  }
+
+  FILE* f = std::tmpfile();
+  std::fwrite(sink.data.data(), 1, sink.data.size(), f);
+  std::fseek(f, 0, SEEK_SET);
+  StdioFileInterface file(f);
+  Decoder decoder(&file);
+  Header header;
+  std::vector<FrameInfo> frames;
+  EXPECT(decoder.probe(header, frames));
+  EXPECT(int(frames.size()) == anim.frames());
+  EXPECT(decoder.readHeader(header));
+
+  std::vector<uint8_t> pixels(size_t(anim.width)*anim.height);
+  Frame frame;
+  frame.pixels = pixels.data();
+  frame.rowstride = anim.width;
+  EXPECT(!decoder.seekFrame(anim.frames(), frame)); // There is no ring frame
+  for (int i=0; i<anim.frames(); ++i) {
+    EXPECT(decoder.readFrame(frame));
+    EXPECT(pixels == anim.pixels[i]);
+  }
+  EXPECT(file.ok());
+  std::fclose(f);
+}
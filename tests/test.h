@@ -0,0 +1,145 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef FLIC_TESTS_TEST_H_INCLUDED
+#define FLIC_TESTS_TEST_H_INCLUDED
+#pragma once
+
+#include "../flic.h"
+#include "../flic_details.h"
+#include "animations.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Minimal test framework: TEST(name) { ... } functions are registered
+// automatically and run by tests/main.cpp.
+
+namespace flic_tests {
+
+  typedef void (*TestFunc)();
+
+  struct TestCase {
+    const char* name;
+    TestFunc func;
+  };
+
+  std::vector<TestCase>& test_cases();
+  int& test_failures();
+
+  struct TestRegister {
+    TestRegister(const char* name, TestFunc func) {
+      test_cases().push_back(TestCase{ name, func });
+    }
+  };
+
+  // Decodes all frames (plus the ring frame) and returns true if
+  // each one has the expected pixels and palette
+  inline bool decode_matches(const Animation& anim, const std::vector<uint8_t>& data) {
+    flic::MemoryFileInterface file(data.data(), data.size());
+    flic::Decoder decoder(&file);
+    flic::Header header;
+    if (!decoder.readHeader(header) ||
+        header.frames != anim.frames() ||
+        header.width != anim.width ||
+        header.height != anim.height)
+      return false;
+
+    std::vector<uint8_t> pixels(size_t(anim.width)*anim.height, 0);
+    flic::Frame frame;
+    frame.pixels = pixels.data();
+    frame.rowstride = anim.width;
+
+    for (int i=0; i<=anim.frames(); ++i) {
+      const int j = (i < anim.frames() ? i: 0);
+      if (!decoder.readFrame(frame) ||
+          pixels != anim.pixels[j] ||
+          frame.colormap != anim.colormaps[j]) {
+        std::printf("  frame %d doesn't match\n", i);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  struct ChunkHeader {
+    size_t offset;
+    uint32_t size;
+    int type;
+  };
+
+  struct FrameHeader {
+    size_t offset;
+    uint32_t size;
+    std::vector<ChunkHeader> chunks;
+  };
+
+  inline int get16(const std::vector<uint8_t>& data, size_t pos) {
+    return (data[pos] | (data[pos+1] << 8));
+  }
+
+  inline uint32_t get32(const std::vector<uint8_t>& data, size_t pos) {
+    return (uint32_t(get16(data, pos)) | (uint32_t(get16(data, pos+2)) << 16));
+  }
+
+  // Walks the frame/chunk headers of an encoded file (without using
+  // the Decoder)
+  inline std::vector<FrameHeader> walk_frames(const std::vector<uint8_t>& data) {
+    std::vector<FrameHeader> frames;
+    size_t pos = 128;
+    while (pos+16 <= data.size() &&
+           get16(data, pos+4) == FLI_FRAME_MAGIC_NUMBER) {
+      FrameHeader frame;
+      frame.offset = pos;
+      frame.size = get32(data, pos);
+      if (frame.size < 16 || pos+frame.size > data.size())
+        break;
+
+      const int nchunks = get16(data, pos+6);
+      size_t chunkPos = pos+16;
+      for (int i=0; i<nchunks && chunkPos+6 <= pos+frame.size; ++i) {
+        ChunkHeader chunk;
+        chunk.offset = chunkPos;
+        chunk.size = get32(data, chunkPos);
+        chunk.type = get16(data, chunkPos+4);
+        if (chunk.size < 6)
+          break;
+        frame.chunks.push_back(chunk);
+        chunkPos += chunk.size;
+      }
+      frames.push_back(frame);
+      pos += frame.size;
+    }
+    return frames;
+  }
+
+  // Number of chunks of the given type in the encoded file
+  inline int count_chunks(const std::vector<uint8_t>& data, int type) {
+    int n = 0;
+    for (const FrameHeader& frame : walk_frames(data))
+      for (const ChunkHeader& chunk : frame.chunks)
+        if (chunk.type == type)
+          ++n;
+    return n;
+  }
+
+} // namespace flic_tests
+
+#define TEST(name)                                                      \
+  static void name();                                                   \
+  static flic_tests::TestRegister name##_register(#name, name);         \
+  static void name()
+
+#define EXPECT(cond)                                                    \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      std::printf("%s:%d: EXPECT(%s) failed\n", __FILE__, __LINE__, #cond); \
+      ++flic_tests::test_failures();                                    \
+    }                                                                   \
+  } while (0)
+
+#endif
@@ -0,0 +1,95 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "flic_threads.h"
+
+namespace flic {
+
+ThreadPool::ThreadPool(int threads)
+  : m_func(nullptr)
+  , m_data(nullptr)
+  , m_n(0)
+  , m_next(0)
+  , m_busyWorkers(0)
+  , m_generation(0)
+  , m_exit(false)
+{
+  if (threads <= 0)
+    threads = int(std::thread::hardware_concurrency());
+
+  for (int i=1; i<threads; ++i)
+    m_workers.emplace_back([this]{ workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exit = true;
+  }
+  m_workCv.notify_all();
+
+  for (std::thread& worker : m_workers)
+    worker.join();
+}
+
+void ThreadPool::run(int n, IterationFunc func, void* data)
+{
+  if (m_workers.empty() || n <= 1) {
+    for (int i=0; i<n; ++i)
+      func(data, i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_func = func;
+    m_data = data;
+    m_n = n;
+    m_next = 0;
+    m_busyWorkers = int(m_workers.size());
+    ++m_generation;
+  }
+  m_workCv.notify_all();
+
+  runIterations();
+
+  // Wait all workers, so "func" can be destroyed safely
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_doneCv.wait(lock, [this]{ return m_busyWorkers == 0; });
+  m_func = nullptr;
+  m_data = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+  uint64_t generation = 0;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_workCv.wait(lock, [this, generation]{
+      return m_exit || m_generation != generation;
+    });
+    if (m_exit)
+      break;
+
+    generation = m_generation;
+    lock.unlock();
+
+    runIterations();
+
+    lock.lock();
+    if (--m_busyWorkers == 0)
+      m_doneCv.notify_one();
+  }
+}
+
+void ThreadPool::runIterations()
+{
+  for (int i=m_next++; i<m_n; i=m_next++)
+    m_func(m_data, i);
+}
+
+} // namespace flic
@@ -0,0 +1,99 @@
+// Aseprite FLIC Library
+// Copyright (c) 2026 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+// Re-encodes FLI/FLC files as FLC files in the given directory:
+//
+//   flic-transcode [-j threads] [-m max_mb] -o output_dir files...
+
+#include "../flic_batch.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+static std::string output_filename(const std::string& dir,
+                                   const std::string& input)
+{
+  std::string name = input;
+  const size_t slash = name.find_last_of("/\\");
+  if (slash != std::string::npos)
+    name.erase(0, slash+1);
+
+  const size_t dot = name.rfind('.');
+  if (dot != std::string::npos)
+    name.erase(dot);
+
+  std::string result = dir;
+  if (!result.empty() && result.back() != '/' && result.back() != '\\')
+    result.push_back('/');
+  return result + name + ".flc";
+}
+
+int main(int argc, char* argv[])
+{
+  int threads = 0;
+  size_t maxMemory = 0;
+  std::string outputDir;
+  std::vector<flic::BatchTranscoder::Job> jobs;
+
+  for (int i=1; i<argc; ++i) {
+    if (std::strcmp(argv[i], "-j") == 0 && i+1 < argc)
+      threads = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "-m") == 0 && i+1 < argc)
+      maxMemory = size_t(std::atoi(argv[++i])) * 1024 * 1024;
+    else if (std::strcmp(argv[i], "-o") == 0 && i+1 < argc)
+      outputDir = argv[++i];
+    else {
+      flic::BatchTranscoder::Job job;
+      job.input = argv[i];
+      jobs.push_back(job);
+    }
+  }
+
+  if (outputDir.empty() || jobs.empty()) {
+    std::fprintf(stderr, "Usage: %s [-j threads] [-m max_mb] -o output_dir files...\n", argv[0]);
+    return 1;
+  }
+
+  // Input files with the same name (e.g. a/x.fli and b/x.flc) would
+  // be written in the same output file at the same time
+  std::set<std::string> outputs;
+  for (auto& job : jobs) {
+    job.output = output_filename(outputDir, job.input);
+    if (!outputs.insert(job.output).second) {
+      std::fprintf(stderr, "%s: output file %s is used by another input file\n",
+                   job.input.c_str(), job.output.c_str());
+      return 1;
+    }
+  }
+
+  flic::BatchTranscoder transcoder(threads, maxMemory);
+  const std::vector<flic::BatchTranscoder::Result> results = transcoder.run(jobs);
+
+  int failed = 0;
+  for (size_t i=0; i<jobs.size(); ++i) {
+    const auto& result = results[i];
+    if (!result.ok) {
+      std::printf("%s: error\n", jobs[i].input.c_str());
+      ++failed;
+      continue;
+    }
+
+    const double mb = double(result.inputBytes) / (1024.0*1024.0);
+    std::printf("%s: %d frames, %zu -> %zu bytes, %.3f ms, %.1f MB/s\n",
+                jobs[i].input.c_str(), result.frames,
+                result.inputBytes, result.outputBytes,
+                result.seconds*1000.0,
+                result.seconds > 0.0 ? mb / result.seconds: 0.0);
+  }
+
+  std::printf("peak memory: %.1f MB\n",
+              double(transcoder.peakMemory()) / (1024.0*1024.0));
+  return (failed > 0 ? 2: 0);
+}